@@ -0,0 +1,264 @@
+#include "agendamodel.h"
+
+#include "listitem.h"
+#include "dateclock.h"
+#include "markdownrenderer.h"
+#include "sqlquery.h"
+#include "constants.h"
+
+#include <QFont>
+#include <QLocale>
+#include <QPalette>
+#include <QApplication>
+
+AgendaModel::AgendaModel(QObject* parent) : QAbstractListModel(parent)
+{
+    reload();
+
+    // every task may change its section
+    connect(DateClock::instance(), &DateClock::dateChanged, this, &AgendaModel::reload);
+}
+
+AgendaModel::~AgendaModel()
+{
+    qDeleteAll(_entries);
+}
+
+void AgendaModel::_clear()
+{
+    qDeleteAll(_entries);
+    _entries.clear();
+    _tasks.clear();
+    _hasMore = true;
+    _lastDate = QDate();
+    _lastId = 0;
+}
+
+void AgendaModel::reload()
+{
+    beginResetModel();
+    _clear();
+    endResetModel();
+    fetchMore(QModelIndex());
+}
+
+void AgendaModel::setDays(int days)
+{
+    if (days == _days)
+        return;
+    _days = days;
+    reload();
+}
+
+bool AgendaModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && _hasMore;
+}
+
+void AgendaModel::fetchMore(const QModelIndex& parent)
+{
+    if (parent.isValid() || !_hasMore)
+        return;
+
+    SqlQuery sql;
+    sql.prepare("SELECT id, content, due_date FROM list_item WHERE due_date IS NOT NULL AND is_cancelled = 0 AND "
+                "is_completed = 0 AND due_date <= :last AND (due_date > :date OR (due_date = :date AND id > :id)) "
+                "ORDER BY due_date ASC, id ASC LIMIT :limit");
+    sql.bindValue(":last", DateClock::instance()->today().addDays(_days).toString(Qt::ISODate));
+    sql.bindValue(":date", _lastDate.isValid() ? _lastDate.toString(Qt::ISODate) : QString(""));
+    sql.bindValue(":id", _lastId);
+    sql.bindValue(":limit", _pageSize);
+    if (!sql.exec()) {
+        _hasMore = false;
+        return;
+    }
+
+    QList<Entry*> entries;
+    int lastSection = _entries.isEmpty() ? -1 : _entries.last()->section;
+    int count = 0;
+    while (sql.next()) {
+        int id = sql.value(0).toInt();
+        QDate dueDate = sql.value(2).toDate();
+        ++count;
+        _lastDate = dueDate;
+        _lastId = id;
+        if (_tasks.contains(id)) // inserted by updateTask
+            continue;
+
+        int section = _section(dueDate);
+        if (section != lastSection) {
+            entries << new Entry{0, section, QDate(), QString()};
+            lastSection = section;
+        }
+        Entry* task = new Entry{id, section, dueDate, MarkdownRenderer::render(sql.value(1).toString()).text.simplified()};
+        entries << task;
+        _tasks[id] = task;
+    }
+    _hasMore = count == _pageSize;
+
+    if (entries.isEmpty())
+        return;
+
+    beginInsertRows(QModelIndex(), _entries.length(), _entries.length() + entries.length() - 1);
+    _entries.append(entries);
+    endInsertRows();
+}
+
+int AgendaModel::_section(const QDate& dueDate) const
+{
+    int days = DateClock::instance()->today().daysTo(dueDate);
+    if (days < 0)
+        return Overdue;
+    if (days == 0)
+        return Today;
+    if (days <= 7)
+        return NextWeek;
+    return Later;
+}
+
+// rows after the keyset are loaded by fetchMore
+bool AgendaModel::_isFetched(const QDate& dueDate, int id) const
+{
+    return !_hasMore || dueDate < _lastDate || (dueDate == _lastDate && id <= _lastId);
+}
+
+// first row which is not ordered before the given task, headers come first in their section
+int AgendaModel::_lowerBound(int section, const QDate& dueDate, int id) const
+{
+    int lo = 0;
+    int hi = _entries.length();
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        Entry* entry = _entries.at(mid);
+        bool isBefore = entry->section < section ||
+                        (entry->section == section &&
+                         (entry->id == 0 || entry->dueDate < dueDate || (entry->dueDate == dueDate && entry->id < id)));
+        if (isBefore)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+void AgendaModel::_insertTask(int id, const QDate& dueDate, const QString& text)
+{
+    int section = _section(dueDate);
+    int row = _lowerBound(section, dueDate, id);
+    Entry* task = new Entry{id, section, dueDate, text};
+    _tasks[id] = task;
+
+    // first task of the section brings its header
+    bool hasHeader = row > 0 && _entries.at(row - 1)->section == section;
+    if (hasHeader) {
+        beginInsertRows(QModelIndex(), row, row);
+        _entries.insert(row, task);
+    } else {
+        beginInsertRows(QModelIndex(), row, row + 1);
+        _entries.insert(row, task);
+        _entries.insert(row, new Entry{0, section, QDate(), QString()});
+    }
+    endInsertRows();
+}
+
+void AgendaModel::_removeTask(Entry* task)
+{
+    int row = _entries.indexOf(task);
+    bool isLast = _entries.at(row - 1)->id == 0 &&
+                  (row + 1 == _entries.length() || _entries.at(row + 1)->section != task->section);
+    int first = isLast ? row - 1 : row;
+
+    beginRemoveRows(QModelIndex(), first, row);
+    for (int i = row; i >= first; --i)
+        delete _entries.takeAt(i);
+    endRemoveRows();
+
+    _tasks.remove(task->id);
+}
+
+void AgendaModel::updateTask(ListItem* item)
+{
+    Entry* task = _tasks.value(item->id());
+    QDate last = DateClock::instance()->today().addDays(_days);
+    bool isShown = item->dueDate().isValid() && item->dueDate() <= last && !item->isCompleted() &&
+                   !item->isCancelled() && _isFetched(item->dueDate(), item->id());
+    QString text = isShown ? item->text().simplified() : QString();
+
+    if (task && isShown && task->dueDate == item->dueDate()) {
+        if (task->text != text) {
+            task->text = text;
+            QModelIndex index = this->index(_entries.indexOf(task));
+            emit dataChanged(index, index);
+        }
+        return;
+    }
+
+    if (task)
+        _removeTask(task);
+    if (isShown)
+        _insertTask(item->id(), item->dueDate(), text);
+}
+
+void AgendaModel::removeTask(int itemId)
+{
+    Entry* task = _tasks.value(itemId);
+    if (task)
+        _removeTask(task);
+}
+
+int AgendaModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : _entries.length();
+}
+
+int AgendaModel::itemId(const QModelIndex& index) const
+{
+    return index.isValid() ? _entries.at(index.row())->id : 0;
+}
+
+QVariant AgendaModel::data(const QModelIndex& index, int role) const
+{
+    static const QString headers[] = { "Overdue", "Today", "Next 7 Days", "Later" };
+
+    if (!index.isValid())
+        return QVariant();
+
+    Entry* entry = _entries.at(index.row());
+    if (entry->id == 0) {
+        switch (role) {
+            case Qt::DisplayRole:
+                return headers[entry->section];
+            case Qt::FontRole: {
+                QFont font = QApplication::font();
+                font.setBold(true);
+                return font;
+            }
+            case Qt::BackgroundRole:
+                return QApplication::palette().window();
+        }
+        return QVariant();
+    }
+
+    switch (role) {
+        case Qt::DisplayRole:
+            if (entry->section == Today)
+                return entry->text;
+            return QLocale().toString(entry->dueDate, QLocale::ShortFormat) + QStringLiteral("  ") + entry->text;
+        case Qt::ForegroundRole:
+            if (entry->section == Overdue)
+                return App::OverdueColor;
+            break;
+        case Qt::ToolTipRole:
+            return entry->text;
+    }
+    return QVariant();
+}
+
+Qt::ItemFlags AgendaModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+    if (_entries.at(index.row())->id == 0)
+        return Qt::ItemIsEnabled;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QDate>
+#include <QHash>
+#include <QList>
+
+class ListItem;
+
+// Flat list of the open tasks due up to N days from today, grouped under section headers.
+// Rows are fetched in pages ordered by (due_date, id) and kept up to date from the list models.
+class AgendaModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum Section { Overdue, Today, NextWeek, Later };
+
+    AgendaModel(QObject* parent = 0);
+    ~AgendaModel();
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    int itemId(const QModelIndex& index) const;
+
+    int days() const { return _days; };
+    void setDays(int days);
+public slots:
+    void reload();
+    void updateTask(ListItem* item);
+    void removeTask(int itemId);
+private:
+    struct Entry
+    {
+        int id; // 0 for section headers
+        int section;
+        QDate dueDate;
+        QString text;
+    };
+
+    QList<Entry*> _entries;
+    QHash<int, Entry*> _tasks;
+    int _days{30};
+    int _pageSize{200};
+
+    // keyset of the last fetched row
+    bool _hasMore{false};
+    QDate _lastDate;
+    int _lastId{0};
+
+    void _clear();
+    int _section(const QDate& dueDate) const;
+    bool _isFetched(const QDate& dueDate, int id) const;
+    int _lowerBound(int section, const QDate& dueDate, int id) const;
+    void _insertTask(int id, const QDate& dueDate, const QString& text);
+    void _removeTask(Entry* task);
+};
@@ -0,0 +1,12 @@
+#include "agendaview.h"
+
+AgendaView::AgendaView(QWidget* parent) : QListView(parent)
+{
+    // one line per task, the view does not measure rows
+    setUniformItemSizes(true);
+    setSelectionMode(QAbstractItemView::SingleSelection);
+    setTextElideMode(Qt::ElideRight);
+
+    _model = new AgendaModel(this);
+    setModel(_model);
+}
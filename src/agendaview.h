@@ -0,0 +1,15 @@
+#pragma once
+
+#include "agendamodel.h"
+
+#include <QListView>
+
+class AgendaView : public QListView
+{
+    Q_OBJECT
+public:
+    AgendaView(QWidget* parent = 0);
+    AgendaModel* model() const { return _model; };
+private:
+    AgendaModel* _model{nullptr};
+};
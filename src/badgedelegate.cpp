@@ -1,12 +1,47 @@
 #include "badgedelegate.h"
+#include "constants.h"
+
+#include <QPainter>
+#include <QApplication>
 
 BadgeDelegate::BadgeDelegate(QWidget* parent)
     : QStyledItemDelegate(parent) {}
 
 void BadgeDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
 {
+    QVariant progress = index.data(App::ProgressRole);
+    if (!progress.isValid()) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
     QStyleOptionViewItem opt = option;
     initStyleOption(&opt, index);
+    QString text = opt.text;
+    opt.text.clear();
+    QStyle* style = opt.widget ? opt.widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, opt.widget);
+
+    QRectF rect = QRectF(opt.rect).adjusted(2, 3, -2, -3);
+    qreal radius = rect.height() / 2;
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(opt.palette.color(QPalette::Mid));
+    painter->drawRoundedRect(rect, radius, radius);
+
+    // clip the filled part to the pill
+    QPainterPath pill;
+    pill.addRoundedRect(rect, radius, radius);
+    painter->setClipPath(pill);
+    painter->setBrush(App::ProgressColor);
+    painter->drawRect(QRectF(rect.topLeft(), QSizeF(rect.width() * progress.toDouble(), rect.height())));
+    painter->setClipping(false);
 
-    // painter->drawEllipse(x, y,
+    QVariant foreground = index.data(Qt::ForegroundRole);
+    painter->setPen(foreground.isValid() ? foreground.value<QColor>() : opt.palette.color(QPalette::BrightText));
+    painter->setFont(opt.font);
+    painter->drawText(rect, Qt::AlignCenter, text);
+    painter->restore();
 }
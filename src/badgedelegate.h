@@ -2,6 +2,7 @@
 
 #include <QStyledItemDelegate>
 
+// Paints the text of App::ProgressRole cells in a pill filled up to the progress
 class BadgeDelegate : public QStyledItemDelegate
 {
 public:
@@ -1,17 +1,38 @@
 #include "calendarwidget.h"
 
+#include "dateclock.h"
+#include "duedatecounts.h"
+#include "constants.h"
+
 #include <QPainter>
 
 CalendarWidget::CalendarWidget(QWidget* parent)
-    : QCalendarWidget(parent), _currentDate(QDate::currentDate())
+    : QCalendarWidget(parent), _currentDate(DateClock::instance()->today())
 {
     _currentDatePen.setColor(Qt::green);
     _currentDateBrush.setColor(Qt::transparent);
+
+    connect(DateClock::instance(), &DateClock::dateChanged, this, [this](const QDate& today) {
+        _currentDate = today;
+        updateCells();
+    });
+    connect(DueDateCounts::instance(), &DueDateCounts::countChanged, this, [this](const QDate& date) {
+        updateCell(date);
+    });
 }
 
 void CalendarWidget::paintCell(QPainter *painter, const QRect &rect, const QDate &date) const
 {
     QCalendarWidget::paintCell(painter, rect, date);
+
+    // darker for busier days, saturates at 10 open tasks
+    int count = DueDateCounts::instance()->count(date);
+    if (count > 0) {
+        QColor color = App::HeatMapColor;
+        color.setAlpha(qMin(count, 10) * 20);
+        painter->fillRect(rect, color);
+    }
+
     if (date == _currentDate) {
         painter->setPen(_currentDatePen);
         painter->setBrush(_currentDateBrush);
@@ -17,8 +17,15 @@ namespace App
     const QColor CancelledColor = QColor(182, 124, 124);
     const QColor CompletedColor = QColor(Qt::gray);
     const QColor NoteColor = _color("#666666");
+    const QColor OverdueColor = _color("#C0392B");
+    const QColor HeatMapColor = _color("#3498DB");
+    const QColor ProgressColor = _color("#2ECC71");
+    const QColor DeadlineColor = _color("#E67E22");
 
     const QColor Priority1Color = _color("#C0392B");
     const QColor Priority2Color = _color("#E67E22");
     const QColor Priority3Color = _color("#27AE60");
+
+    // indexed by ItemTextColor
+    const QColor ItemTextColors[] = { QColor(Qt::black), CompletedColor, CancelledColor, NoteColor };
 }
@@ -7,12 +7,17 @@
 namespace App
 {
 enum Direction { Up, Down, Left, Right };
-enum ItemDataRole { ExpandedStateRole = Qt::UserRole + 10, OriginalTextRole, ProjectRole };
+enum ItemDataRole { ExpandedStateRole = Qt::UserRole + 10, OriginalTextRole, ProjectRole, RevisionRole, ProgressRole };
 enum EditorTab { SimpleEditorTab = 0, TextEditorTab };
 enum SortMode { SortByStatus, SortByStatusAndContent };
 enum AppendMode { AppendChild, AppendBefore, AppendAfter };
 enum ItemState { CheckableState, CompletedState, CancelledState, ProjectState, HighlightedState };
 
+// item style indexes, see ListItem::background(), icon() and textColor()
+enum ItemBackground { NoBackground, HighlightBackground, ProjectBackground, MilestoneBackground };
+enum ItemIcon { NoIcon, ProjectIcon, MilestoneIcon, NoteIcon };
+enum ItemTextColor { DefaultTextColor, CompletedTextColor, CancelledTextColor, NoteTextColor };
+
 extern const QColor HighlightBackgroundColor;
 extern const QColor ProjectBackgroundColor;
 extern const QColor MilestoneBackgroundColor;
@@ -20,8 +25,14 @@ extern const QColor MilestoneBackgroundColor;
 extern const QColor CompletedColor;
 extern const QColor CancelledColor;
 extern const QColor NoteColor;
+extern const QColor OverdueColor;
+extern const QColor HeatMapColor;
+extern const QColor ProgressColor;
+extern const QColor DeadlineColor;
 
 extern const QColor Priority1Color;
 extern const QColor Priority2Color;
 extern const QColor Priority3Color;
+
+extern const QColor ItemTextColors[];
 }
@@ -1,10 +1,12 @@
 #include "databaseutil.h"
 #include "sqlquery.h"
+#include "tagindex.h"
 
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
+#include <QRegularExpression>
 
 DatabaseUtil::DatabaseUtil(const QString& dbPath): _dbPath(dbPath), _failed(false)
 {
@@ -143,6 +145,39 @@ bool DatabaseUtil::migrate()
         case 14:
             dropColumn("list_item", "note");
             setVersion(db, 15);
+        case 15:
+            // the original indexes were lost when dropColumn rebuilt the table
+            runSql("DROP INDEX IF EXISTS idx_list_item_list");
+            runSql("DROP INDEX IF EXISTS idx_list_item_parent");
+            // tree loads and sibling renumbering
+            runSql("CREATE INDEX idx_list_item_tree ON list_item (list_id, parent_id, weight)");
+            // schedule
+            runSql("CREATE INDEX idx_list_item_due_date ON list_item (due_date) WHERE due_date IS NOT NULL AND is_cancelled = 0");
+            // outliner
+            runSql("CREATE INDEX idx_list_item_outline ON list_item (list_id, parent_id) WHERE is_project = 1 OR is_milestone = 1");
+            setVersion(db, 16);
+        case 16:
+            createSearchIndex();
+            setVersion(db, 17);
+        case 17:
+            // saved filters shown as lists, see SmartFilter
+            runSql("CREATE TABLE smart_filter ("
+                   "  id INTEGER NOT NULL PRIMARY KEY,"
+                   "  name TEXT NOT NULL,"
+                   "  query TEXT NOT NULL,"
+                   "  weight INTEGER NOT NULL)");
+            runSql("CREATE INDEX idx_list_item_completed_at ON list_item (completed_at) WHERE completed_at IS NOT NULL");
+            setVersion(db, 18);
+        case 18:
+            runSql("CREATE TABLE item_tag ("
+                   "  item_id INTEGER NOT NULL REFERENCES list_item (id),"
+                   "  tag TEXT NOT NULL,"
+                   "  PRIMARY KEY (item_id, tag)) WITHOUT ROWID");
+            runSql("CREATE INDEX idx_item_tag_tag ON item_tag (tag, item_id)");
+            runSql("CREATE TRIGGER list_item_tag_delete AFTER DELETE ON list_item BEGIN "
+                   "DELETE FROM item_tag WHERE item_id = old.id; END");
+            createTags();
+            setVersion(db, 19);
     }
 
     if (!_failed)
@@ -220,6 +255,66 @@ void DatabaseUtil::backup()
     }
 }
 
+// full text index over list_item.content, fts5 when the sqlite library has it, fts4 otherwise
+void DatabaseUtil::createSearchIndex()
+{
+    if (_failed)
+        return;
+
+    SqlQuery sql;
+    sql.prepare("SELECT sqlite_compileoption_used('ENABLE_FTS5')");
+    bool isFts5 = sql.exec() && sql.next() && sql.value(0).toBool();
+
+    if (isFts5) {
+        runSql("CREATE VIRTUAL TABLE list_item_fts USING fts5(content, content = 'list_item', content_rowid = 'id')");
+        runSql("CREATE TRIGGER list_item_fts_insert AFTER INSERT ON list_item BEGIN "
+               "INSERT INTO list_item_fts (rowid, content) VALUES (new.id, new.content); END");
+        runSql("CREATE TRIGGER list_item_fts_delete AFTER DELETE ON list_item BEGIN "
+               "INSERT INTO list_item_fts (list_item_fts, rowid, content) VALUES ('delete', old.id, old.content); END");
+        runSql("CREATE TRIGGER list_item_fts_update AFTER UPDATE OF content ON list_item BEGIN "
+               "INSERT INTO list_item_fts (list_item_fts, rowid, content) VALUES ('delete', old.id, old.content); "
+               "INSERT INTO list_item_fts (rowid, content) VALUES (new.id, new.content); END");
+    } else {
+        runSql("CREATE VIRTUAL TABLE list_item_fts USING fts4(content, content = 'list_item')");
+        runSql("CREATE TRIGGER list_item_fts_insert AFTER INSERT ON list_item BEGIN "
+               "INSERT INTO list_item_fts (docid, content) VALUES (new.id, new.content); END");
+        runSql("CREATE TRIGGER list_item_fts_delete BEFORE DELETE ON list_item BEGIN "
+               "DELETE FROM list_item_fts WHERE docid = old.id; END");
+        runSql("CREATE TRIGGER list_item_fts_update_before BEFORE UPDATE OF content ON list_item BEGIN "
+               "DELETE FROM list_item_fts WHERE docid = old.id; END");
+        runSql("CREATE TRIGGER list_item_fts_update_after AFTER UPDATE OF content ON list_item BEGIN "
+               "INSERT INTO list_item_fts (docid, content) VALUES (new.id, new.content); END");
+    }
+    runSql("INSERT INTO list_item_fts (list_item_fts) VALUES ('rebuild')");
+}
+
+// extract the tags of the existing items, see TagIndex
+void DatabaseUtil::createTags()
+{
+    if (_failed)
+        return;
+
+    SqlQuery select;
+    select.prepare("SELECT id, content FROM list_item WHERE content LIKE '%#%' OR content LIKE '%@%'");
+    if (!select.exec()) {
+        _failed = true;
+        return;
+    }
+
+    SqlQuery insert;
+    insert.prepare("INSERT INTO item_tag (item_id, tag) VALUES (:id, :tag)");
+    while (select.next()) {
+        for (const QString& tag : TagIndex::extract(select.value(1).toString())) {
+            insert.bindValue(":id", select.value(0));
+            insert.bindValue(":tag", tag);
+            if (!insert.exec()) {
+                _failed = true;
+                return;
+            }
+        }
+    }
+}
+
 void DatabaseUtil::addColumn(const QString& table, const QString& colspec)
 {
     runSql(QString("ALTER TABLE %0 ADD %1").arg(table).arg(colspec));
@@ -286,6 +381,27 @@ bool DatabaseUtil::_migrateTableInner(const QString& table, const QStringList& d
         newColumnsSpec << colSpec.join(' ');
     }
 
+    // indexes and triggers are dropped with the table, keep the ones that do not use a dropped or renamed column
+    sql.prepare("SELECT sql FROM sqlite_master WHERE type IN ('index', 'trigger') AND tbl_name = :table AND sql IS NOT NULL");
+    sql.bindValue(":table", table);
+    if (!sql.exec())
+        return false;
+
+    QStringList schema;
+    while (sql.next()) {
+        QString schemaSql = sql.value(0).toString();
+        bool isValid = true;
+        for (int i = 0; i < oldColumns.length() && isValid; ++i)
+            if (oldColumns.at(i) != newColumns.at(i))
+                isValid = !schemaSql.contains(QRegularExpression("\\b" + oldColumns.at(i) + "\\b"));
+        for (int i = 0; i < droppedColumns.length() && isValid; ++i)
+            isValid = !schemaSql.contains(QRegularExpression("\\b" + droppedColumns.at(i) + "\\b"));
+        if (isValid)
+            schema << schemaSql;
+        else
+            qDebug() << "Not recreated:" << schemaSql;
+    }
+
     QString newTable = table + "_temp";
 
     sql.prepare(QString("CREATE TABLE %0 (%1)").arg(newTable).arg(newColumnsSpec.join(',')));
@@ -309,5 +425,11 @@ bool DatabaseUtil::_migrateTableInner(const QString& table, const QStringList& d
     if (!sql.exec())
         return false;
 
+    for (auto schemaSql : schema) {
+        sql.prepare(schemaSql);
+        if (!sql.exec())
+            return false;
+    }
+
     return true;
 }
@@ -19,6 +19,8 @@ public:
     void setVersion(QSqlDatabase& db, int value);
     void runSql(const QString& sql);
     bool tableExists(const QString& table);
+    void createSearchIndex();
+    void createTags();
     void addColumn(const QString& table, const QString& colspec);
     void dropColumn(const QString& table, const QString& column);
     void dropColumn(const QString& table, const QStringList& columns);
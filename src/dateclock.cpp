@@ -0,0 +1,35 @@
+#include "dateclock.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+
+DateClock* DateClock::instance()
+{
+    static DateClock* clock = new DateClock(QCoreApplication::instance());
+    return clock;
+}
+
+DateClock::DateClock(QObject* parent) : QObject(parent), _today(QDate::currentDate())
+{
+    _timer.setSingleShot(true);
+    connect(&_timer, &QTimer::timeout, this, &DateClock::_update);
+    _startTimer();
+}
+
+void DateClock::_update()
+{
+    QDate today = QDate::currentDate();
+    if (today != _today) {
+        QDate previous = _today;
+        _today = today;
+        emit dateChanged(today, previous);
+    }
+    _startTimer();
+}
+
+void DateClock::_startTimer()
+{
+    // a little after midnight, the timer may fire early
+    qint64 msecs = QDateTime::currentDateTime().msecsTo(QDateTime(_today.addDays(1), QTime(0, 0)));
+    _timer.start(static_cast<int>(qMax<qint64>(msecs, 0)) + 1000);
+}
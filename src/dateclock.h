@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QObject>
+#include <QDate>
+#include <QTimer>
+
+// Caches today's date and emits dateChanged at local midnight.
+class DateClock : public QObject
+{
+    Q_OBJECT
+public:
+    static DateClock* instance();
+    QDate today() const { return _today; };
+signals:
+    void dateChanged(const QDate& today, const QDate& previous);
+private:
+    DateClock(QObject* parent = 0);
+
+    QDate _today;
+    QTimer _timer;
+
+    void _update();
+    void _startTimer();
+};
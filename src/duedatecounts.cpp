@@ -0,0 +1,47 @@
+#include "duedatecounts.h"
+
+#include "sqlquery.h"
+
+#include <QCoreApplication>
+
+DueDateCounts* DueDateCounts::instance()
+{
+    static DueDateCounts* counts = new DueDateCounts(QCoreApplication::instance());
+    return counts;
+}
+
+DueDateCounts::DueDateCounts(QObject* parent) : QObject(parent) {}
+
+void DueDateCounts::_load()
+{
+    _isLoaded = true;
+
+    SqlQuery sql;
+    sql.prepare("SELECT due_date, COUNT(*) FROM list_item WHERE due_date IS NOT NULL AND is_cancelled = 0 AND "
+                "is_completed = 0 GROUP BY due_date");
+    if (!sql.exec())
+        return;
+    while (sql.next())
+        _counts[sql.value(0).toDate()] = sql.value(1).toInt();
+}
+
+int DueDateCounts::count(const QDate& date)
+{
+    if (!_isLoaded)
+        _load();
+    return _counts.value(date);
+}
+
+// changes before the first load are already in the database
+void DueDateCounts::add(const QDate& date, int delta)
+{
+    if (!_isLoaded || !date.isValid())
+        return;
+
+    int count = _counts.value(date) + delta;
+    if (count > 0)
+        _counts[date] = count;
+    else
+        _counts.remove(date);
+    emit countChanged(date, count);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QObject>
+#include <QDate>
+#include <QHash>
+
+// Number of open tasks per due date. Loaded with one GROUP BY query on first use, then kept current by the list
+// items as their due date or status changes.
+class DueDateCounts : public QObject
+{
+    Q_OBJECT
+public:
+    static DueDateCounts* instance();
+
+    int count(const QDate& date);
+    void add(const QDate& date, int delta);
+signals:
+    void countChanged(const QDate& date, int count);
+private:
+    DueDateCounts(QObject* parent = 0);
+
+    bool _isLoaded{false};
+    QHash<QDate, int> _counts;
+
+    void _load();
+};
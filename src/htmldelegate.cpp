@@ -1,9 +1,11 @@
 #include "htmldelegate.h"
+#include "constants.h"
 #include "debug.h"
 
 #include <QAbstractTextDocumentLayout>
 #include <QApplication>
 #include <QPainter>
+#include <QPixmapCache>
 #include <QTextDocument>
 
 int HtmlDelegate::cbWidth = 0;
@@ -23,7 +25,60 @@ QColor HtmlDelegate::textColor(const QModelIndex& index) const
     return QColor(Qt::black);
 }
 
+void HtmlDelegate::setPixmapCacheEnabled(bool enabled, int limitKb)
+{
+    _isPixmapCacheEnabled = enabled;
+    if (enabled && QPixmapCache::cacheLimit() < limitKb)
+        QPixmapCache::setCacheLimit(limitKb);
+}
+
 void HtmlDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    QVariant revision;
+    if (_isPixmapCacheEnabled)
+        revision = index.data(App::RevisionRole);
+    if (!revision.isValid()) {
+        paintItem(painter, option, index);
+        return;
+    }
+
+    const QRect rect = option.rect;
+    const int state = option.state & (QStyle::State_Enabled | QStyle::State_Active | QStyle::State_Selected |
+                                      QStyle::State_MouseOver | QStyle::State_HasFocus);
+    const qreal ratio = painter->device()->devicePixelRatioF();
+    const QString key = QStringLiteral("HtmlDelegate:%1:%2:%3:%4x%5@%6:%7:%8:%9")
+                            .arg(quintptr(this), 0, 16)
+                            .arg(index.column())
+                            .arg(revision.toInt())
+                            .arg(rect.width())
+                            .arg(rect.height())
+                            .arg(ratio)
+                            .arg(state)
+                            .arg(int(option.features))
+                            .arg(displayMode());
+
+    QPixmap pixmap;
+    if (QPixmapCache::find(key, &pixmap)) {
+        ++_cacheHits;
+    } else {
+        ++_cacheMisses;
+
+        pixmap = QPixmap(rect.size() * ratio);
+        pixmap.setDevicePixelRatio(ratio);
+        pixmap.fill(Qt::transparent);
+
+        QStyleOptionViewItem opt = option;
+        opt.rect = QRect(QPoint(0, 0), rect.size());
+        QPainter pixmapPainter(&pixmap);
+        paintItem(&pixmapPainter, opt, index);
+        pixmapPainter.end();
+
+        QPixmapCache::insert(key, pixmap);
+    }
+    painter->drawPixmap(rect.topLeft(), pixmap);
+}
+
+void HtmlDelegate::paintItem(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
 {
     QStyleOptionViewItem opt = option;
     initStyleOption(&opt, index);
@@ -14,6 +14,20 @@ public:
     virtual QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const;
     int checkboxWidth(QStyle* style, QWidget* parent, const QStyleOptionViewItem& opt) const;
     int iconWidth(QStyle* style, QWidget* parent, const QStyleOptionViewItem& opt) const;
+
+    // cache rendered rows of models that provide App::RevisionRole
+    void setPixmapCacheEnabled(bool enabled, int limitKb = 65536);
+    bool isPixmapCacheEnabled() const { return _isPixmapCacheEnabled; };
+    int cacheHits() const { return _cacheHits; };
+    int cacheMisses() const { return _cacheMisses; };
+protected:
+    virtual void paintItem(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const;
+    // part of the cache key, for subclasses rendering the same revision in several ways
+    virtual int displayMode() const { return 0; };
 private:
     static int cbWidth;
+
+    bool _isPixmapCacheEnabled{false};
+    mutable int _cacheHits{0};
+    mutable int _cacheMisses{0};
 };
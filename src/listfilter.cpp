@@ -0,0 +1,92 @@
+#include "listfilter.h"
+
+#include "listitem.h"
+#include "listmodel.h"
+#include "tagindex.h"
+
+bool CompletedFilter::accepts(ListItem* item) const
+{
+    return !item->isCompleted() && !item->isCancelled();
+}
+
+bool TextFilter::accepts(ListItem* item) const
+{
+    return _matches.contains(item) || _ancestors.contains(item);
+}
+
+// a new row stays visible until its edit is committed, it is then tested like any edited item
+QList<ListItem*> TextFilter::itemAdded(ListItem* item)
+{
+    return _setMatch(item, true);
+}
+
+QList<ListItem*> TextFilter::itemChanged(ListItem* item)
+{
+    return _setMatch(item, _isMatch(item));
+}
+
+// the rows are being removed, the ancestors are left as they are until the text changes
+void TextFilter::itemRemoved(ListItem* item)
+{
+    _setMatch(item, false);
+    _ancestors.remove(item);
+}
+
+void TextFilter::setText(const QString& text, const ListModel* model)
+{
+    _text = text;
+    _isTag = TagIndex::isTag(text);
+    _matches.clear();
+    _ancestors.clear();
+
+    QList<ListItem*> items;
+    if (_isTag)
+        _findTagged(model->root(), TagIndex::instance()->items(text), items);
+    else
+        items = model->textIndex()->find(text);
+
+    for (ListItem* item : items)
+        _setMatch(item, true);
+}
+
+bool TextFilter::_isMatch(ListItem* item) const
+{
+    if (_isTag)
+        return TagIndex::instance()->items(_text).contains(item->id());
+    return item->text().contains(_text, Qt::CaseInsensitive);
+}
+
+// the item and the ancestors which gained their first or lost their last match
+QList<ListItem*> TextFilter::_setMatch(ListItem* item, bool isMatch)
+{
+    QList<ListItem*> changed;
+    if (isMatch == _matches.contains(item))
+        return changed;
+
+    changed << item;
+    if (isMatch)
+        _matches.insert(item);
+    else
+        _matches.remove(item);
+
+    for (ListItem* parent = item->parent(); parent && !parent->isRoot(); parent = parent->parent()) {
+        int count = _ancestors.value(parent) + (isMatch ? 1 : -1);
+        if (count > 0)
+            _ancestors.insert(parent, count);
+        else
+            _ancestors.remove(parent);
+        if (count == 0 || (isMatch && count == 1))
+            changed << parent;
+    }
+    return changed;
+}
+
+void TextFilter::_findTagged(ListItem* parent, const QSet<int>& ids, QList<ListItem*>& items)
+{
+    for (int i = 0, n = parent->childCount(); i < n; ++i) {
+        ListItem* child = parent->child(i);
+        if (ids.contains(child->id()))
+            items << child;
+        _findTagged(child, ids, items);
+    }
+}
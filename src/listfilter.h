@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+class ListItem;
+class ListModel;
+
+// Decides whether an item is visible in the list tree. Filters are installed on a ListModel which keeps a hidden
+// flag on every item and only reports the rows whose state actually changed.
+class ListFilter
+{
+public:
+    virtual ~ListFilter() {}
+    virtual bool accepts(ListItem* item) const = 0;
+
+    // for the filters keeping state about the items, return the items whose state may have changed
+    virtual QList<ListItem*> itemAdded(ListItem* item) { Q_UNUSED(item); return QList<ListItem*>(); };
+    virtual QList<ListItem*> itemChanged(ListItem* item) { Q_UNUSED(item); return QList<ListItem*>(); };
+    virtual void itemRemoved(ListItem* item) { Q_UNUSED(item); };
+};
+
+class CompletedFilter : public ListFilter
+{
+public:
+    bool accepts(ListItem* item) const override;
+};
+
+// items containing a text or having a #tag or @context, and their ancestors so the matches keep their place in the
+// tree. The matches are searched once when the text is set and then followed as items are added, edited and removed.
+class TextFilter : public ListFilter
+{
+public:
+    bool accepts(ListItem* item) const override;
+    QList<ListItem*> itemAdded(ListItem* item) override;
+    QList<ListItem*> itemChanged(ListItem* item) override;
+    void itemRemoved(ListItem* item) override;
+
+    QString text() const { return _text; };
+    void setText(const QString& text, const ListModel* model);
+    QList<ListItem*> ancestors() const { return _ancestors.keys(); };
+private:
+    QString _text;
+    bool _isTag{false};
+    QSet<ListItem*> _matches;
+    QHash<ListItem*, int> _ancestors; // number of matches below each ancestor
+
+    bool _isMatch(ListItem* item) const;
+    QList<ListItem*> _setMatch(ListItem* item, bool isMatch);
+    void _findTagged(ListItem* parent, const QSet<int>& ids, QList<ListItem*>& items);
+};
@@ -3,21 +3,26 @@
 #include "listmodel.h"
 #include "sqlquery.h"
 #include "utils.h"
+#include "duedatecounts.h"
+#include "tagindex.h"
 #include "debug.h"
 
-#include <QTextDocument>
+#include <QLocale>
 
-const MarkdownRenderer ListItem::renderer{};
+int ListItem::_lastRevision = 0;
 
 ListItem::ListItem(ListModel* model, int listId) : QObject(), _listId(listId), _isRoot(true)
 {
     setModel(model);
+    _updateRollup();
 }
 
 ListItem::ListItem(int listId, int id, QString content)
     : QObject(), _listId(listId), _id(id), _markdown(content)
 {
     _setMarkdown(content);
+    _updateStyle();
+    _updateRollup();
 }
 
 ListItem::ListItem(int listId, int id, QString content, bool isExpanded, bool isProject,
@@ -37,7 +42,9 @@ ListItem::ListItem(int listId, int id, QString content, bool isExpanded, bool is
         _isCancelled = isCancelled;
     }
     _priority = priority;
-    _dueDate = dueDate;
+    _setDueDate(dueDate);
+    _updateStyle();
+    _updateRollup();
 }
 
 ListItem::~ListItem() { qDeleteAll(_children); }
@@ -153,16 +160,22 @@ ListItem* ListItem::lastChild() const
 
 void ListItem::appendChild(ListItem* child)
 {
+    _touch();
     child->setParent(this, _children.length());
     _children.append(child);
+    _updateStyle();
+    _addRollup(child->_rollup, 1);
 }
 
 void ListItem::insertChild(int row, ListItem* child)
 {
+    _touch();
     for (int i = row, n = _children.length(); i < n; ++i)
         _children.at(i)->_adjustRow(1);
     child->setParent(this, row);
     _children.insert(row, child);
+    _updateStyle();
+    _addRollup(child->_rollup, 1);
 }
 
 void ListItem::removeChild(int row)
@@ -171,38 +184,44 @@ void ListItem::removeChild(int row)
     if (!(row >= 0 && row < nchild))
         return;
 
+    _touch();
     for (int i = row + 1; i < nchild; ++i)
         _children.at(i)->_adjustRow(-1);
 
     ListItem* item = _children.takeAt(row);
+    _addRollup(item->_rollup, -1);
     delete item;
+    _updateStyle();
 }
 
-void ListItem::moveChild(int row) { _children.move(row, row + 1); }
-
-bool ListItem::takeChildDb(int row)
+// the children keep their parent until they are inserted again
+QList<ListItem*> ListItem::takeChildren(int row, int count)
 {
-    SqlQuery sql;
-    sql.prepare("UPDATE list_item SET weight = weight - 1 WHERE list_id = :list AND parent_id = "
-                ":parent AND weight > :row");
-    sql.bindValue(":list", _listId);
-    sql.bindValue(":parent", _id);
-    sql.bindValue(":row", row);
-    return sql.exec();
+    _touch();
+    QList<ListItem*> children = _children.mid(row, count);
+    _children.erase(_children.begin() + row, _children.begin() + row + count);
+    for (int i = row, n = _children.length(); i < n; ++i)
+        _children.at(i)->_adjustRow(-count);
+    for (ListItem* child : children)
+        _addRollup(child->_rollup, -1);
+    _updateStyle();
+    return children;
 }
 
-ListItem* ListItem::takeChild(int row)
+void ListItem::insertChildren(int row, const QList<ListItem*>& children)
 {
-    int nchild = _children.length();
-    if (!(row >= 0 && row < nchild))
-        return nullptr;
-
-    for (int i = row + 1; i < nchild; ++i)
-        _children.at(i)->_adjustRow(-1);
-
-    ListItem* child = _children.takeAt(row);
-    child->setParent(nullptr, 0);
-    return child;
+    _touch();
+    int count = children.length();
+    for (int i = row, n = _children.length(); i < n; ++i)
+        _children.at(i)->_adjustRow(count);
+    for (int i = 0; i < count; ++i) {
+        ListItem* child = children.at(i);
+        child->_row = row + i; // so setParent does not save the row again
+        child->setParent(this, row + i);
+        _children.insert(row + i, child);
+        _addRollup(child->_rollup, 1);
+    }
+    _updateStyle();
 }
 
 bool ListItem::setRow(int row)
@@ -212,12 +231,11 @@ bool ListItem::setRow(int row)
 
 void ListItem::_setMarkdown(const QString& value)
 {
+    _touch();
     _markdown = value;
-    _html = renderer.convert(value);
-
-    QTextDocument doc;
-    doc.setHtml(_html);
-    _text = doc.toPlainText();
+    MarkdownRenderer::Rendered rendered = MarkdownRenderer::render(value);
+    _html = rendered.html;
+    _text = rendered.text;
 
     _label = _text.replace('\n', " ").replace('\r', " ");
     if (_label.length() > 80) {
@@ -228,7 +246,18 @@ void ListItem::_setMarkdown(const QString& value)
 
 bool ListItem::setMarkdown(const QString& markdown)
 {
-    return markdown == _markdown || _setAttribute("content", markdown) && (_setMarkdown(markdown), true);
+    if (markdown == _markdown)
+        return true;
+    if (!_setAttribute("content", markdown))
+        return false;
+    QStringList tags = TagIndex::extract(markdown);
+    if (tags != TagIndex::extract(_markdown))
+        TagIndex::instance()->setTags(_id, tags);
+    _setMarkdown(markdown);
+    _scheduleChanged();
+    if (_model)
+        _model->itemTextChanged(this);
+    return true;
 }
 
 void ListItem::setParent(ListItem* parent, int row)
@@ -238,51 +267,15 @@ void ListItem::setParent(ListItem* parent, int row)
         setLevel(parent->level() + 1);
         setRow(row);
         setModel(parent->model());
+        _setDeadline(parent->_childDeadline());
     } else {
         setLevel(0);
         setRow(0);
         setModel(nullptr);
+        _setDeadline(QDate());
     }
 }
 
-bool ListItem::setParentDb(ListItem* parent, int row)
-{
-    if (parent == _parent && row == _row)
-        return true;
-
-    QSqlDatabase db = QSqlDatabase::database();
-    bool localTransaction = db.transaction();
-    bool success = true;
-
-    SqlQuery sql;
-
-    int parentId = parent->id();
-
-    sql.prepare("UPDATE list_item SET weight = weight + 1 WHERE list_id = :list AND parent_id = "
-                ":parent AND weight >= :row");
-    sql.bindValue(":list", _listId);
-    sql.bindValue(":parent", parentId);
-    sql.bindValue(":row", row);
-    if (!sql.exec())
-        success = false;
-    else {
-        sql.prepare("UPDATE list_item SET parent_id = :parent, weight = :row WHERE id = :id");
-        sql.bindValue(":parent", parentId);
-        sql.bindValue(":row", row);
-        sql.bindValue(":id", _id);
-        if (!sql.exec())
-            success = false;
-    }
-
-    if (localTransaction)
-        if (success)
-            db.commit();
-        else
-            db.rollback();
-
-    return success;
-}
-
 void ListItem::setLevel(int level)
 {
     _level = level;
@@ -298,6 +291,7 @@ bool ListItem::setExpanded(bool isExpanded)
 
 void ListItem::_setCheckable(const bool isCheckable)
 {
+    _touch();
     _isCheckable = isCheckable;
     setFlag(Qt::ItemIsUserCheckable, isCheckable);
     if (!isCheckable) {
@@ -306,32 +300,36 @@ void ListItem::_setCheckable(const bool isCheckable)
         if (isCancelled())
             setCancelled(false);
     }
+    _updateStyle();
+    _updateRollup();
+    _scheduleChanged();
 }
 
+// the completed and cancelled states are reset by the same statement, so nothing changes in memory when it fails
 bool ListItem::setCheckable(const bool isCheckable)
 {
     if (isCheckable == _isCheckable)
         return true;
 
-    QSqlDatabase db = QSqlDatabase::database();
-    bool localTrans = db.transaction();
-
-    bool success = true;
-    if (_setAttribute("is_checkable", isCheckable ? 1 : 0)) {
-        _setCheckable(isCheckable);
-        if (!isCheckable) {
-            if (isCompleted())
-                success = setCompleted(false);
-            if (success)
-                if (isCancelled())
-                    success = setCancelled(false);
-        }
-    } else
-        success = false;
+    bool isClosed = _isCompleted || _isCancelled;
+    SqlQuery sql;
+    if (isCheckable)
+        sql.prepare("UPDATE list_item SET is_checkable = 1 WHERE id = :id");
+    else if (isClosed)
+        sql.prepare("UPDATE list_item SET is_checkable = 0, is_completed = 0, is_cancelled = 0, completed_at = CURRENT_TIMESTAMP WHERE id = :id");
+    else
+        sql.prepare("UPDATE list_item SET is_checkable = 0 WHERE id = :id");
+    sql.bindValue(":id", _id);
+    if (!sql.exec())
+        return false;
 
-    if (localTrans)
-        success ? db.commit() : db.rollback();
-    return success;
+    if (!isCheckable && isClosed) {
+        _isCompleted = false;
+        _isCancelled = false;
+        DueDateCounts::instance()->add(_dueDate, 1);
+    }
+    _setCheckable(isCheckable);
+    return true;
 }
 
 bool ListItem::setCompleted(const bool isCompleted)
@@ -339,7 +337,9 @@ bool ListItem::setCompleted(const bool isCompleted)
     if (!_isCheckable || _isCancelled)
         return false;
     return isCompleted == _isCompleted ||
-           _setAttribute("is_completed", isCompleted ? 1 : 0) && (_isCompleted = isCompleted, true);
+           _setAttribute("is_completed", isCompleted ? 1 : 0) &&
+           (_isCompleted = isCompleted, DueDateCounts::instance()->add(_dueDate, isCompleted ? -1 : 1),
+            _updateStyle(), _updateRollup(), _scheduleChanged(), true);
 }
 
 bool ListItem::setCancelled(const bool isCancelled)
@@ -347,7 +347,9 @@ bool ListItem::setCancelled(const bool isCancelled)
     if (!_isCheckable || _isCompleted)
         return false;
     return isCancelled == _isCancelled ||
-           _setAttribute("is_cancelled", isCancelled) && (_isCancelled = isCancelled, true);
+           _setAttribute("is_cancelled", isCancelled) &&
+           (_isCancelled = isCancelled, DueDateCounts::instance()->add(_dueDate, isCancelled ? -1 : 1),
+            _updateStyle(), _updateRollup(), _scheduleChanged(), true);
 }
 
 bool ListItem::setProject(const bool isProject)
@@ -386,10 +388,8 @@ bool ListItem::setProject(const bool isProject)
 
     if (_setAttribute("is_project", isProject)) {
         _isProject = isProject;
-        if (isProject)
-            emit _model->projectAdded(this);
-        else
-            emit _model->projectRemoved();
+        _updateStyle();
+        _updateRollup();
         return true;
     }
     return false;
@@ -415,8 +415,8 @@ bool ListItem::setMilestone(const bool isMilestone)
         return true;
     if (_setAttribute("is_milestone", isMilestone)) {
         _isMilestone = isMilestone;
-        if (_model)
-            emit isMilestone ? _model->projectAdded(this) : _model->projectRemoved();
+        _updateStyle();
+        _updateRollup();
         return true;
     }
     return false;
@@ -424,29 +424,204 @@ bool ListItem::setMilestone(const bool isMilestone)
 
 bool ListItem::setHighlighted(const bool isHighlighted)
 {
-    return isHighlighted == _isHighlighted || _setAttribute("is_highlighted", isHighlighted) && (_isHighlighted = isHighlighted, true);
+    return isHighlighted == _isHighlighted || _setAttribute("is_highlighted", isHighlighted) && (_isHighlighted = isHighlighted, _updateStyle(), true);
 }
 
 bool ListItem::setDueDate(const QDate& dueDate)
 {
     if (dueDate == _dueDate)
         return true;
-    if (_setAttribute("due_date", dueDate.isValid() ? dueDate.toString(Qt::ISODate) : QVariant())) {
-        _dueDate = dueDate;
-        emit scheduleChanged();
-        return true;
+    if (!_setAttribute("due_date", dueDate.isValid() ? dueDate.toString(Qt::ISODate) : QVariant()))
+        return false;
+    applyDueDate(dueDate);
+    return true;
+}
+
+void ListItem::applyDueDate(const QDate& dueDate)
+{
+    if (dueDate == _dueDate)
+        return;
+
+    _touch();
+    bool wasScheduled = _dueDate.isValid();
+    _countDueDate(-1);
+    _setDueDate(dueDate);
+    _countDueDate(1);
+    _updateRollup();
+    for (ListItem* child : _children)
+        child->_setDeadline(_childDeadline());
+    if (wasScheduled || dueDate.isValid())
+        emit scheduleChanged(this);
+}
+
+ListItem::Attributes ListItem::attributes() const
+{
+    return Attributes{_isCheckable, _isCompleted, _isCancelled, _isProject, _isMilestone, _isHighlighted, _priority};
+}
+
+void ListItem::restoreAttributes(const Attributes& attributes)
+{
+    _countDueDate(-1);
+    _isCheckable = attributes.isCheckable;
+    setFlag(Qt::ItemIsUserCheckable, _isCheckable);
+    _isCompleted = attributes.isCompleted;
+    _isCancelled = attributes.isCancelled;
+    _isProject = attributes.isProject;
+    _isMilestone = attributes.isMilestone;
+    _isHighlighted = attributes.isHighlighted;
+    _priority = attributes.priority;
+    _countDueDate(1);
+
+    _touch();
+    _updateStyle();
+    _updateRollup();
+    _scheduleChanged();
+}
+
+// goes down until the descendants having their own due date
+void ListItem::_setDeadline(const QDate& deadline)
+{
+    if (deadline == _deadline)
+        return;
+    _deadline = deadline;
+
+    if (_dueDate.isValid()) {
+        if (_model)
+            _model->repaintItem(this);
+        return;
     }
-    return false;
+    for (ListItem* child : _children)
+        child->_setDeadline(deadline);
+}
+
+// counts the current due date if the task is open
+void ListItem::_countDueDate(int delta)
+{
+    if (!_isCompleted && !_isCancelled)
+        DueDateCounts::instance()->add(_dueDate, delta);
+}
+
+void ListItem::_setDueDate(const QDate& dueDate)
+{
+    _dueDate = dueDate;
+    _dueDateText = dueDate.isValid() ? QLocale().toString(dueDate, QLocale::ShortFormat) : QString();
+}
+
+void ListItem::_updateStyle()
+{
+    int background = App::NoBackground;
+    if (_isHighlighted)
+        background = App::HighlightBackground;
+    else if (_isProject)
+        background = App::ProjectBackground;
+    else if (_isMilestone)
+        background = App::MilestoneBackground;
+
+    int icon = App::NoIcon;
+    if (_isProject)
+        icon = App::ProjectIcon;
+    else if (_isMilestone)
+        icon = App::MilestoneIcon;
+    else if (isNote())
+        icon = App::NoteIcon;
+
+    int textColor = App::DefaultTextColor;
+    if (_isCompleted)
+        textColor = App::CompletedTextColor;
+    else if (_isCancelled)
+        textColor = App::CancelledTextColor;
+    else if (isNote())
+        textColor = App::NoteTextColor;
+
+    _style = background | (icon << 2) | (textColor << 4);
 }
 
 bool ListItem::setPriority(int priority)
 {
     if (_isMilestone) // milestone is ordered by date not priority
         return false;
-    return priority == _priority || _setAttribute("priority", priority) && (_priority = priority, true);
+    return priority == _priority || _setAttribute("priority", priority) && (_priority = priority, _updateRollup(), true);
 }
 
-bool ListItem::_setAttribute(const QString& column, QVariant value) const
+int ListItem::highestOpenPriority() const
+{
+    for (int priority = 1; priority < 4; ++priority)
+        if (_rollup.openByPriority[priority] > 0)
+            return priority;
+    return 0;
+}
+
+ListItem::Rollup ListItem::_computeOwnRollup() const
+{
+    Rollup rollup;
+    if (_isRoot)
+        return rollup;
+
+    rollup.items = 1;
+    rollup.outlines = _isProject || _isMilestone ? 1 : 0;
+    if (_isCheckable) {
+        bool isOpen = !_isCompleted && !_isCancelled;
+        rollup.open = isOpen ? 1 : 0;
+        rollup.completed = _isCompleted ? 1 : 0;
+        if (isOpen)
+            rollup.openByPriority[qBound(0, _priority, 3)] = 1;
+    }
+    if (!_isCompleted && !_isCancelled)
+        rollup.earliestDue = _dueDate;
+    return rollup;
+}
+
+// after a change of the item itself
+void ListItem::_updateRollup()
+{
+    Rollup own = _computeOwnRollup();
+    Rollup delta;
+    delta.items = own.items - _ownRollup.items;
+    delta.open = own.open - _ownRollup.open;
+    delta.completed = own.completed - _ownRollup.completed;
+    for (int i = 0; i < 4; ++i)
+        delta.openByPriority[i] = own.openByPriority[i] - _ownRollup.openByPriority[i];
+    delta.outlines = own.outlines - _ownRollup.outlines;
+    _ownRollup = own;
+    _addRollup(delta, 1);
+}
+
+// the counts are added to the item and its ancestors, the earliest due date is refreshed upwards while it changes.
+// The items which start or stop containing an outline are repainted too so the outline filters them again.
+void ListItem::_addRollup(const Rollup& rollup, int sign)
+{
+    for (ListItem* item = this; item; item = item->_parent) {
+        bool hadOutline = item->hasOutline();
+        item->_rollup.items += sign * rollup.items;
+        item->_rollup.open += sign * rollup.open;
+        item->_rollup.completed += sign * rollup.completed;
+        for (int i = 0; i < 4; ++i)
+            item->_rollup.openByPriority[i] += sign * rollup.openByPriority[i];
+        item->_rollup.outlines += sign * rollup.outlines;
+        if (item->_model && (item->_isProject || item->_isMilestone || hadOutline != item->hasOutline()))
+            item->_model->repaintItem(item);
+    }
+
+    for (ListItem* item = this; item && item->_updateEarliestDue(); item = item->_parent)
+        if (item->_model && (item->_isProject || item->_isMilestone))
+            item->_model->repaintItem(item);
+}
+
+bool ListItem::_updateEarliestDue()
+{
+    QDate earliest = _ownRollup.earliestDue;
+    for (ListItem* child : _children) {
+        const QDate& date = child->_rollup.earliestDue;
+        if (date.isValid() && (!earliest.isValid() || date < earliest))
+            earliest = date;
+    }
+    if (earliest == _rollup.earliestDue)
+        return false;
+    _rollup.earliestDue = earliest;
+    return true;
+}
+
+bool ListItem::_setAttribute(const QString& column, QVariant value)
 {
     QString sql;
     if (column == "content")
@@ -460,5 +635,8 @@ bool ListItem::_setAttribute(const QString& column, QVariant value) const
     q.prepare(sql);
     q.bindValue(":id", _id);
     q.bindValue(QStringLiteral(":") + column, value);
-    return q.exec();
+    if (!q.exec())
+        return false;
+    _touch();
+    return true;
 }
@@ -12,6 +12,29 @@ class ListItem : public QObject
 {
     Q_OBJECT
 public:
+    // aggregates of the subtree, the item included, kept current as items change or are added and removed
+    struct Rollup
+    {
+        int items{0};
+        int open{0}; // open tasks
+        int completed{0};
+        int openByPriority[4]{0, 0, 0, 0};
+        int outlines{0}; // projects and milestones
+        QDate earliestDue; // of the open items
+    };
+
+    // the flags changed by ListModel::updateItems, to put them back in memory when its transaction fails
+    struct Attributes
+    {
+        bool isCheckable;
+        bool isCompleted;
+        bool isCancelled;
+        bool isProject;
+        bool isMilestone;
+        bool isHighlighted;
+        int priority;
+    };
+
     // root
     ListItem(ListModel* model, int listId);
     // new item
@@ -28,7 +51,9 @@ public:
     bool sort(App::SortMode mode);
 
     int id() const { return _id; };
+    int listId() const { return _listId; };
     int weight() const;
+    int revision() const { return _revision; }; // changes whenever the item needs to be repainted
 
     QString html() const;
     QString text() const { return _text; };
@@ -44,12 +69,17 @@ public:
     void appendChild(ListItem* child);
     void insertChild(int row, ListItem* child);
     void removeChild(int row);
-    void moveChild(int row);
-    bool takeChildDb(int row);
-    ListItem* takeChild(int row);
+    // moves a range of children in memory, the rows are already saved
+    QList<ListItem*> takeChildren(int row, int count);
+    void insertChildren(int row, const QList<ListItem*>& children);
     bool isLastChild() const { return _parent && _parent->childCount() == _row + 1; };
     bool isNote() const { return !_isCheckable && !_isProject && !_isMilestone && !_isHighlighted && _children.length() == 0; };
 
+    // style indexes packed into one byte and maintained by the setters
+    App::ItemBackground background() const { return static_cast<App::ItemBackground>(_style & 0x3); };
+    App::ItemIcon icon() const { return static_cast<App::ItemIcon>((_style >> 2) & 0x3); };
+    App::ItemTextColor textColor() const { return static_cast<App::ItemTextColor>((_style >> 4) & 0x3); };
+
     int row() const { return _row; };
     bool setRow(int row);
 
@@ -58,7 +88,6 @@ public:
 
     ListItem* parent() const { return _parent; };
     void setParent(ListItem* parent, int row);
-    bool setParentDb(ListItem* parent, int row);
 
     int level() const { return _level; };
     void setLevel(const int level);
@@ -85,12 +114,27 @@ public:
     bool setHighlighted(const bool isHighlighted);
 
     QDate dueDate() const { return _dueDate; };
+    QString dueDateText() const { return _dueDateText; };
+    bool isOverdue(const QDate& today) const { return _dueDate.isValid() && _dueDate < today && !_isCompleted && !_isCancelled; };
     bool setDueDate(const QDate& dueDate);
+    void applyDueDate(const QDate& dueDate); // the database is already updated
+    Attributes attributes() const;
+    void restoreAttributes(const Attributes& attributes); // the database is already rolled back
+    QDate deadline() const { return _deadline; }; // nearest due date of the ancestors
+    bool isPastDeadline() const { return _dueDate.isValid() && _deadline.isValid() && _dueDate > _deadline; };
 
     int priority() const { return _priority; };
     bool setPriority(int priority);
+
+    const Rollup& rollup() const { return _rollup; };
+    int descendantCount() const { return _rollup.items - 1; };
+    bool hasOutline() const { return _rollup.outlines > 0; }; // is or contains a project or milestone
+    int highestOpenPriority() const;
+
+    bool isFiltered() const { return _isFiltered; };
+    void setFiltered(bool isFiltered) { _isFiltered = isFiltered; };
 signals:
-    void scheduleChanged();
+    void scheduleChanged(ListItem* item);
     void operationError(const QString& message);
 private:
     ListModel* _model{nullptr};
@@ -100,6 +144,7 @@ private:
     int _id{0}; // 0 means root
     int _row{0};
     int _priority{0};
+    int _revision{0};
 
     QString _markdown;
     QString _html;
@@ -113,7 +158,11 @@ private:
     bool _isCompleted{false};
     bool _isCancelled{false};
     bool _isHighlighted{false};
+    bool _isFiltered{false}; // hidden by the model filters
+    quint8 _style{0};
     QDate _dueDate;
+    QString _dueDateText;
+    QDate _deadline;
 
     ListItem* _parent{nullptr};
     int _level{0};
@@ -121,10 +170,24 @@ private:
 
     QList<ListItem*> _children;
 
-    static const MarkdownRenderer renderer;
+    Rollup _rollup;
+    Rollup _ownRollup; // the part of _rollup coming from the item itself
+
+    static int _lastRevision;
 
     void _adjustRow(int delta) { _row += delta; };
+    void _touch() { _revision = ++_lastRevision; };
+    void _scheduleChanged() { if (_dueDate.isValid()) emit scheduleChanged(this); };
+    void _countDueDate(int delta);
+    void _updateStyle();
+    Rollup _computeOwnRollup() const;
+    void _updateRollup();
+    void _addRollup(const Rollup& rollup, int sign);
+    bool _updateEarliestDue();
+    void _setDueDate(const QDate& dueDate);
+    void _setDeadline(const QDate& deadline);
+    QDate _childDeadline() const { return _dueDate.isValid() ? _dueDate : _deadline; };
     void _setMarkdown(const QString& value);
     void _setCheckable(bool isCheckable);
-    bool _setAttribute(const QString& column, QVariant value) const;
+    bool _setAttribute(const QString& column, QVariant value);
 };
@@ -3,6 +3,10 @@
 #include "listtree.h"
 #include "constants.h"
 
+#include <QApplication>
+#include <QHelpEvent>
+#include <QToolTip>
+
 ListItemDelegate::ListItemDelegate(ListTree* parent) : HtmlDelegateTree(parent) {}
 
 ListTree* ListItemDelegate::parent() const
@@ -13,15 +17,65 @@ ListTree* ListItemDelegate::parent() const
 QColor ListItemDelegate::textColor(const QModelIndex& index) const
 {
     ListItem* item = parent()->model()->itemFromIndex(index);
+    if (item)
+        return App::ItemTextColors[item->textColor()];
+    return QColor(Qt::black);
+}
 
-    if (item) {
-        if (item->isCompleted())
-            return App::CompletedColor;
-        if (item->isCancelled())
-            return App::CancelledColor;
-        if (item->isNote())
-            return App::NoteColor;
+// compact mode: a single elided line of plain text, rendered by the style without QTextDocument
+void ListItemDelegate::_initCompactOption(QStyleOptionViewItem* opt, const QModelIndex& index) const
+{
+    initStyleOption(opt, index);
+
+    ListItem* item = parent()->model()->itemFromIndex(index);
+    opt->text = item->label();
+    opt->textElideMode = Qt::ElideRight;
+    opt->features &= ~QStyleOptionViewItem::WrapText;
+    if (item->isProject())
+        opt->font.setBold(true);
+
+    const QColor color = textColor(index);
+    if (color != QColor(Qt::black))
+        opt->palette.setColor(QPalette::Text, color);
+}
+
+void ListItemDelegate::paintItem(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    if (!parent()->isCompact()) {
+        HtmlDelegateTree::paintItem(painter, option, index);
+        return;
     }
 
-    return QColor(Qt::black);
+    QStyleOptionViewItem opt = option;
+    _initCompactOption(&opt, index);
+
+    QStyle* style = opt.widget ? opt.widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, opt.widget);
+}
+
+int ListItemDelegate::displayMode() const { return parent()->isCompact() ? 1 : 0; }
+
+QSize ListItemDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    if (!parent()->isCompact())
+        return HtmlDelegateTree::sizeHint(option, index);
+
+    QStyleOptionViewItem opt = option;
+    _initCompactOption(&opt, index);
+
+    QStyle* style = opt.widget ? opt.widget->style() : QApplication::style();
+    return style->sizeFromContents(QStyle::CT_ItemViewItem, &opt, QSize(), opt.widget);
+}
+
+// in compact mode the full rendered note is shown as a tooltip since the rows cannot grow
+bool ListItemDelegate::helpEvent(QHelpEvent* event, QAbstractItemView* view, const QStyleOptionViewItem& option, const QModelIndex& index)
+{
+    if (parent()->isCompact() && event->type() == QEvent::ToolTip && index.isValid()) {
+        ListItem* item = parent()->model()->itemFromIndex(index);
+        if (item) {
+            QToolTip::showText(event->globalPos(), item->html(), view);
+            return true;
+        }
+    }
+    return HtmlDelegateTree::helpEvent(event, view, option, index);
 }
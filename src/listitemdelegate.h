@@ -10,4 +10,11 @@ public:
     ListItemDelegate(ListTree* parent);
     ListTree* parent() const;
     QColor textColor(const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    bool helpEvent(QHelpEvent* event, QAbstractItemView* view, const QStyleOptionViewItem& option, const QModelIndex& index) override;
+protected:
+    void paintItem(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    int displayMode() const override;
+private:
+    void _initCompactOption(QStyleOptionViewItem* opt, const QModelIndex& index) const;
 };
@@ -3,14 +3,33 @@
 #include "listtree.h"
 #include "sqlquery.h"
 #include "utils.h"
+#include "dateclock.h"
+#include "duedatecounts.h"
+#include "tagindex.h"
 #include "debug.h"
 
 #include <QDateTime>
+#include <QLocale>
+#include <QMimeData>
+#include <QSqlError>
+#include <QDataStream>
+
+#include <algorithm>
 
 ListModel::ListModel(int listId, ListTree* parent) : QAbstractItemModel(parent), _listId(listId)
 {
     _root = new ListItem(this, listId);
     _loadItems(_root);
+    _changedItems.clear(); // the rollups and deadlines computed while loading are not shown yet
+
+    // item changes are merged and reported at most once per frame
+    _changeTimer.setSingleShot(true);
+    _changeTimer.setInterval(16);
+    connect(&_changeTimer, &QTimer::timeout, this, &ListModel::_emitChanges);
+
+    connect(DateClock::instance(), &DateClock::dateChanged, this, [this](const QDate& today, const QDate& previous) {
+        _changeDate(_root, qMin(today, previous), qMax(today, previous));
+    });
 }
 
 ListModel::~ListModel()
@@ -60,6 +79,7 @@ void ListModel::_loadItems(ListItem* parent)
 
         ListItem* item = new ListItem(_listId, id, content, isExpanded, isProject, isMilestone, isHighlighted, isCheckable, isCompleted, isCancelled, dueDate, priority);
         parent->appendChild(item);
+        _textIndex.insert(item);
 
         _loadItems(item);
 
@@ -77,7 +97,7 @@ int ListModel::rowCount(const QModelIndex& parent) const
 
 int ListModel::columnCount(const QModelIndex& parent) const
 {
-    return (parent.column()) > 0 ? 0 : 2;
+    return (parent.column()) > 0 ? 0 : 3;
 }
 
 QModelIndex ListModel::index(int row, int column, const QModelIndex& parent) const
@@ -114,20 +134,17 @@ QModelIndex ListModel::parent(const QModelIndex& index) const
 
 QVariant ListModel::data(const QModelIndex& index, int role) const
 {
+    // indexed by App::ItemBackground and App::ItemIcon, built once so data() does no color or icon lookups
+    static const QVariant backgrounds[] = { QVariant(), App::HighlightBackgroundColor, App::ProjectBackgroundColor, App::MilestoneBackgroundColor };
+    static const QVariant icons[] = { QVariant(), Util::findIcon("project"), Util::findIcon("milestone"), Util::findIcon("note") };
+
     if (index.isValid()) {
         ListItem* item = itemFromIndex(index);
         if (item) {
             // all columns
             switch (role) {
                 case Qt::BackgroundRole:
-                    if (item->isHighlighted())
-                        return App::HighlightBackgroundColor;
-                    else if (item->isProject())
-                        return App::ProjectBackgroundColor;
-                    else if (item->isMilestone())
-                        return App::MilestoneBackgroundColor;
-                    else
-                        return QVariant();
+                    return backgrounds[item->background()];
             }
             // specific column
             switch (index.column()) {
@@ -137,6 +154,8 @@ QVariant ListModel::data(const QModelIndex& index, int role) const
                             return item->html();
                         case Qt::EditRole:
                             return item->markdown();
+                        case App::RevisionRole:
+                            return item->revision();
                         case Qt::CheckStateRole:
                             if (item->isCheckable())
                                 if (item->isCompleted())
@@ -147,13 +166,7 @@ QVariant ListModel::data(const QModelIndex& index, int role) const
                                     return Qt::Unchecked;
                             break;
                         case Qt::DecorationRole:
-                            if (item->isProject())
-                                return Util::findIcon("project");
-                            if (item->isMilestone())
-                                return Util::findIcon("milestone");
-                            if (item->isNote())
-                                return Util::findIcon("note");
-                            break;
+                            return icons[item->icon()];
 #ifdef QT_DEBUG
                         case Qt::ToolTipRole:
                             return QString("id: %1 row: %2 parent: %3 milestone: %4 priority: %5").arg(item->id()).arg(item->row()).arg(item->parent()->id()).arg(item->isMilestone()).arg(item->priority());
@@ -162,8 +175,44 @@ QVariant ListModel::data(const QModelIndex& index, int role) const
                 case 1:
                     switch (role) {
                         case Qt::DisplayRole:
-                            return item->dueDate();
+                            return item->dueDateText();
+                        case Qt::ForegroundRole:
+                            if (item->isOverdue(DateClock::instance()->today()))
+                                return App::OverdueColor;
+                            if (item->isPastDeadline())
+                                return App::DeadlineColor;
+                            break;
+                        case Qt::ToolTipRole:
+                            if (item->isPastDeadline())
+                                return "After the parent due date " + QLocale().toString(item->deadline(), QLocale::ShortFormat);
+                            break;
                     } break;
+                // progress of projects and milestones
+                case 2: {
+                    const ListItem::Rollup& rollup = item->rollup();
+                    int tasks = rollup.open + rollup.completed;
+                    if (!(item->isProject() || item->isMilestone()) || tasks == 0)
+                        break;
+                    switch (role) {
+                        case Qt::DisplayRole:
+                            return QString("%1/%2").arg(rollup.completed).arg(tasks);
+                        case App::ProgressRole:
+                            return double(rollup.completed) / tasks;
+                        case Qt::ForegroundRole:
+                            if (rollup.earliestDue.isValid() && rollup.earliestDue < DateClock::instance()->today())
+                                return App::OverdueColor;
+                            break;
+                        case Qt::ToolTipRole: {
+                            QString tip = QString("%1 items, %2 open, %3 completed")
+                                              .arg(item->descendantCount()).arg(rollup.open).arg(rollup.completed);
+                            if (item->highestOpenPriority())
+                                tip += QString("\nHighest priority: %1").arg(item->highestOpenPriority());
+                            if (rollup.earliestDue.isValid())
+                                tip += "\nNext due: " + QLocale().toString(rollup.earliestDue, QLocale::ShortFormat);
+                            return tip;
+                        }
+                    }
+                } break;
             }
         }
     }
@@ -214,18 +263,95 @@ QVariant ListModel::headerData(int section, Qt::Orientation orientation, int rol
         switch (section) {
             case 0: return "Task";
             case 1: return "Due Date";
+            case 2: return "Progress";
         }
     return QVariant();
 }
 
 Qt::ItemFlags ListModel::flags(const QModelIndex& index) const
 {
-    int flags = QAbstractItemModel::flags(index);
+    int flags = QAbstractItemModel::flags(index) | Qt::ItemIsDropEnabled;
     if (index.isValid())
-        flags |= itemFromIndex(index)->flags();
+        flags |= itemFromIndex(index)->flags() | Qt::ItemIsDragEnabled;
     return flags;
 }
 
+QStringList ListModel::mimeTypes() const
+{
+    return QStringList{QStringLiteral("application/x-outliner-items")};
+}
+
+// the list and the ids of the dragged items
+QMimeData* ListModel::mimeData(const QModelIndexList& indexes) const
+{
+    QByteArray encoded;
+    QDataStream stream(&encoded, QIODevice::WriteOnly);
+    stream << _listId;
+    QSet<ListItem*> items;
+    for (const QModelIndex& index : indexes)
+        if (index.isValid())
+            items.insert(itemFromIndex(index));
+    for (ListItem* item : items)
+        stream << item->id();
+
+    QMimeData* data = new QMimeData;
+    data->setData(mimeTypes().first(), encoded);
+    return data;
+}
+
+// dropped on an item the subtrees become its last children
+bool ListModel::dropMimeData(const QMimeData* data, Qt::DropAction action, int row, int column, const QModelIndex& parent)
+{
+    Q_UNUSED(column);
+    if (action != Qt::MoveAction || !data->hasFormat(mimeTypes().first()))
+        return false;
+
+    QByteArray encoded = data->data(mimeTypes().first());
+    QDataStream stream(&encoded, QIODevice::ReadOnly);
+    int listId = 0;
+    stream >> listId;
+    if (listId != _listId) // other list
+        return false;
+    QSet<int> ids;
+    while (!stream.atEnd()) {
+        int id = 0;
+        stream >> id;
+        ids.insert(id);
+    }
+
+    // one walk to find all the items
+    QModelIndexList indexes;
+    _findItems(_root, ids, indexes);
+
+    ListItem* parentItem = itemFromIndex(parent);
+    if (row < 0)
+        row = parentItem->childCount();
+    if (!moveItems(indexes, parent, row))
+        return false;
+    if (!parentItem->isRoot())
+        parentItem->setExpanded(true);
+    return true;
+}
+
+void ListModel::_findItems(ListItem* parent, QSet<int>& ids, QModelIndexList& indexes) const
+{
+    for (int i = 0, n = parent->childCount(); i < n && !ids.isEmpty(); ++i) {
+        ListItem* child = parent->child(i);
+        if (ids.remove(child->id()))
+            indexes << indexFromItem(child);
+        _findItems(child, ids, indexes);
+    }
+}
+
+bool ListModel::moveRows(const QModelIndex& sourceParent, int sourceRow, int count, const QModelIndex& destinationParent,
+                         int destinationChild)
+{
+    ListItem* srcParent = itemFromIndex(sourceParent);
+    ListItem* dstParent = itemFromIndex(destinationParent);
+    return srcParent && dstParent && _canMoveRows(srcParent, sourceRow, count, dstParent, destinationChild) &&
+           _moveRows(srcParent, sourceRow, count, dstParent, destinationChild);
+}
+
 QModelIndex ListModel::indexFromId(int itemId) const
 {
     ListItem* found = itemFromId(itemId);
@@ -297,6 +423,10 @@ QModelIndex ListModel::_appendAfter(ListItem* item, const QString& content, App:
 
     int id = sql.lastInsertId().toInt();
 
+    QStringList tags = TagIndex::extract(content);
+    if (!tags.isEmpty())
+        TagIndex::instance()->setTags(id, tags);
+
     beginInsertRows(indexFromItem(parent), row, row);
     ListItem* newItem = new ListItem(_listId, id, content);
     parent->insertChild(row, newItem);
@@ -304,6 +434,10 @@ QModelIndex ListModel::_appendAfter(ListItem* item, const QString& content, App:
         newItem->setCheckable(true);
     endInsertRows();
 
+    _textIndex.insert(newItem);
+    _updateFilters(newItem, true);
+    _applyFilters(newItem);
+
     return indexFromItem(newItem);
 }
 
@@ -318,7 +452,7 @@ QModelIndex ListModel::appendChild(const QModelIndex& parent, int row, QString c
 
     SqlQuery sql;
 
-    sql.prepare("UPDATE list_item SET weight = weight + 1 WHERE parent_id = :parent AND weight >= :row");
+    sql.prepare("UPDATE list_item SET weight = weight + 1 WHERE list_id = :list AND parent_id = :parent AND weight >= :row");
     sql.bindValue(":list", _listId);
     sql.bindValue(":parent", parentItem->id());
     sql.bindValue(":row", row);
@@ -335,6 +469,10 @@ QModelIndex ListModel::appendChild(const QModelIndex& parent, int row, QString c
 
     int id = sql.lastInsertId().toInt();
 
+    QStringList tags = TagIndex::extract(content);
+    if (!tags.isEmpty())
+        TagIndex::instance()->setTags(id, tags);
+
     beginInsertRows(parent, row, row);
     ListItem* newItem = new ListItem(_listId, id, content);
     if (isNewItemCheckable(parentItem, row))
@@ -342,6 +480,10 @@ QModelIndex ListModel::appendChild(const QModelIndex& parent, int row, QString c
     parentItem->insertChild(row, newItem);
     endInsertRows();
 
+    _textIndex.insert(newItem);
+    _updateFilters(newItem, true);
+    _applyFilters(newItem);
+
     return indexFromItem(newItem);
 }
 
@@ -378,154 +520,596 @@ void ListModel::sort(ListItem* parent, App::SortMode mode)
 }
 
 QModelIndex ListModel::moveItemVertical(const QModelIndex& index, App::Direction direction)
+{
+    return moveItemTo(index, index.row() + (direction == App::Up ? -1 : 1));
+}
+
+// targetRow is the row of the item after the move, the siblings in between are renumbered at once
+QModelIndex ListModel::moveItemTo(const QModelIndex& index, int targetRow)
 {
     ListItem* item = itemFromIndex(index);
-    if (!item)
+    if (!index.isValid() || !item)
         return index;
 
+    ListItem* parent = item->parent();
     int row = item->row();
-    if (direction == App::Up && row == 0)
+    if (targetRow == row || targetRow < 0 || targetRow >= parent->childCount())
         return index;
 
-    ListItem* parent = item->parent();
-    if (direction == App::Down && row == (parent->childCount() - 1))
+    int dstRow = targetRow > row ? targetRow + 1 : targetRow;
+    if (!_canMoveRows(parent, row, 1, parent, dstRow) || !_moveRows(parent, row, 1, parent, dstRow))
         return index;
+    return indexFromItem(item);
+}
+
+QModelIndex ListModel::moveItemHorizontal(const QModelIndex& index, int direction)
+{
+    ListItem* item = itemFromIndex(index);
+    if (!item)
+        return index;
+
+    if (direction == App::Left)
+        outdentItems({index});
+    else
+        indentItems({index});
+    return indexFromItem(item);
+}
+
+void ListModel::removeItem(const QModelIndex& index)
+{
+    removeItems({index});
+}
+
+bool ListModel::_canMoveRows(ListItem* srcParent, int srcRow, int count, ListItem* dstParent, int dstRow) const
+{
+    int srcEnd = srcRow + count;
+    if (count <= 0 || srcRow < 0 || srcEnd > srcParent->childCount() || dstRow < 0 || dstRow > dstParent->childCount())
+        return false;
+    // already there
+    if (srcParent == dstParent && dstRow >= srcRow && dstRow <= srcEnd)
+        return false;
+    // into its own subtree
+    for (ListItem* parent = dstParent; parent && !parent->isRoot(); parent = parent->parent())
+        if (parent->parent() == srcParent && parent->row() >= srcRow && parent->row() < srcEnd)
+            return false;
+    return true;
+}
 
-    ListItem* otherItem = parent->child(direction == App::Up ? row - 1 : row + 1);
-    int downRow = direction == App::Down ? row : row - 1; // the row that is being moved down
+// moves count siblings with their subtrees, dstRow is counted before the move like in beginMoveRows. The descendants
+// keep their parent so only the moved rows and the siblings around them are updated. The items are only moved once
+// the rows are saved, inside a batch the caller rolls back its transaction when this fails.
+bool ListModel::_moveRows(ListItem* srcParent, int srcRow, int count, ListItem* dstParent, int dstRow)
+{
+    int srcEnd = srcRow + count;
 
     QSqlDatabase db = QSqlDatabase::database();
-    db.transaction();
+    bool isTransaction = db.transaction();
+    bool success = true;
 
-    if (item->setRow(direction == App::Down ? row + 1 : row - 1) &&
-        otherItem->setRow(row)) {
-        db.commit();
-        if (beginMoveRows(index.parent(), downRow, downRow, index.parent(), downRow + 2)) {
-            parent->moveChild(downRow);
-            endMoveRows();
-            return indexFromItem(item);
+    SqlQuery sql;
+    if (srcParent == dstParent) {
+        // one pass over the rows between the old and the new position
+        bool isUp = dstRow < srcRow;
+        sql.prepare("UPDATE list_item SET weight = weight + "
+                    "CASE WHEN weight >= :src AND weight < :srcEnd THEN :movedDelta ELSE :siblingDelta END "
+                    "WHERE list_id = :list AND parent_id = :parent AND weight >= :low AND weight < :high");
+        sql.bindValue(":src", srcRow);
+        sql.bindValue(":srcEnd", srcEnd);
+        sql.bindValue(":movedDelta", isUp ? dstRow - srcRow : dstRow - srcEnd);
+        sql.bindValue(":siblingDelta", isUp ? count : -count);
+        sql.bindValue(":list", _listId);
+        sql.bindValue(":parent", srcParent->id());
+        sql.bindValue(":low", isUp ? dstRow : srcRow);
+        sql.bindValue(":high", isUp ? srcEnd : dstRow);
+        success = sql.exec();
+    } else {
+        // open a gap at the destination, move the rows into it and close the gap at the source
+        sql.prepare("UPDATE list_item SET weight = weight + :count WHERE list_id = :list AND parent_id = :parent AND weight >= :row");
+        sql.bindValue(":count", count);
+        sql.bindValue(":list", _listId);
+        sql.bindValue(":parent", dstParent->id());
+        sql.bindValue(":row", dstRow);
+        success = sql.exec();
+
+        if (success) {
+            sql.prepare("UPDATE list_item SET parent_id = :dstParent, weight = weight + :delta "
+                        "WHERE list_id = :list AND parent_id = :srcParent AND weight >= :src AND weight < :srcEnd");
+            sql.bindValue(":dstParent", dstParent->id());
+            sql.bindValue(":delta", dstRow - srcRow);
+            sql.bindValue(":list", _listId);
+            sql.bindValue(":srcParent", srcParent->id());
+            sql.bindValue(":src", srcRow);
+            sql.bindValue(":srcEnd", srcEnd);
+            success = sql.exec();
         }
-    } else
-        db.rollback();
-    return index;
+
+        if (success) {
+            sql.prepare("UPDATE list_item SET weight = weight - :count WHERE list_id = :list AND parent_id = :parent AND weight >= :row");
+            sql.bindValue(":count", count);
+            sql.bindValue(":list", _listId);
+            sql.bindValue(":parent", srcParent->id());
+            sql.bindValue(":row", srcEnd);
+            success = sql.exec();
+        }
+    }
+
+    if (isTransaction)
+        success ? db.commit() : db.rollback();
+    if (!success)
+        return false;
+
+    _moveChildren(srcParent, srcRow, count, dstParent, dstRow);
+    return true;
 }
 
-QModelIndex ListModel::moveItemHorizontal(const QModelIndex& index, int direction)
+// the in memory part of _moveRows, the rows are already saved
+void ListModel::_moveChildren(ListItem* srcParent, int srcRow, int count, ListItem* dstParent, int dstRow)
 {
-    ListItem* item = itemFromIndex(index);
-    if (!item)
-        return index;
+    beginMoveRows(indexFromItem(srcParent), srcRow, srcRow + count - 1, indexFromItem(dstParent), dstRow);
+    QList<ListItem*> items = srcParent->takeChildren(srcRow, count);
+    dstParent->insertChildren(srcParent == dstParent && dstRow > srcRow ? dstRow - count : dstRow, items);
+    endMoveRows();
+}
 
-    ListItem* parent = item->parent();
-    int row = item->row();
+// commits the transaction of a batch of moves, or rolls it back and puts the runs already moved back in place
+bool ListModel::_endMoves(const QList<MovedRun>& moved, bool success)
+{
+    QSqlDatabase db = QSqlDatabase::database();
+    if (success) {
+        db.commit();
+        return !moved.isEmpty();
+    }
 
-    if (direction == App::Left) { // reparent as child of parent's parent
-        if (!parent || parent->isRoot()) // already top level item
-            return index;
-
-        ListItem* newParent = parent->parent();
-        int newRow = parent->row() + 1;
-
-        QSqlDatabase db = QSqlDatabase::database();
-        db.transaction();
-        if (parent->takeChildDb(row) &&
-            item->setParentDb(newParent, newRow)) {
-            db.commit();
-            if (beginMoveRows(indexFromItem(parent), row, row, indexFromItem(newParent), newRow)) {
-                newParent->insertChild(newRow, parent->takeChild(row));
-                endMoveRows();
-            }
-            return indexFromItem(item);
-        } else {
-            db.rollback();
-            return index;
+    db.rollback();
+    for (int i = moved.length() - 1; i >= 0; --i) {
+        const MovedRun& run = moved.at(i);
+        ListItem* parent = run.first->parent();
+        int row = run.first->row();
+        _moveChildren(parent, row, run.count, run.parent, run.parent == parent && run.row > row ? run.row + run.count : run.row);
+    }
+    return false;
+}
+
+// the selected items without the ones inside another selected item, grouped by runs of adjacent siblings in tree order
+QList<QList<ListItem*>> ListModel::_siblingRuns(const QModelIndexList& indexes) const
+{
+    QSet<ListItem*> selected;
+    for (const QModelIndex& index : indexes)
+        if (index.isValid())
+            selected.insert(itemFromIndex(index));
+
+    QList<QPair<QVector<int>, ListItem*>> items;
+    for (ListItem* item : selected) {
+        bool isInside = false;
+        QVector<int> path;
+        for (ListItem* curr = item; curr && !curr->isRoot(); curr = curr->parent()) {
+            if (curr != item && selected.contains(curr))
+                isInside = true;
+            path.prepend(curr->row());
         }
-    } else { // move as child of previous sibling
-        ListItem* newParent = parent->child(row - 1);
-        if (!newParent)
-            return index;
-
-        QSqlDatabase db = QSqlDatabase::database();
-        db.transaction();
-        if (parent->takeChildDb(row) &&
-            item->setParentDb(newParent, newParent->childCount())) {
-            db.commit();
-            if (beginMoveRows(indexFromItem(parent), row, row, indexFromItem(newParent), newParent->childCount())) {
-                newParent->appendChild(parent->takeChild(row));
-                endMoveRows();
+        if (!isInside)
+            items << qMakePair(path, item);
+    }
+    std::sort(items.begin(), items.end(), [](const QPair<QVector<int>, ListItem*>& a, const QPair<QVector<int>, ListItem*>& b) {
+        return std::lexicographical_compare(a.first.begin(), a.first.end(), b.first.begin(), b.first.end());
+    });
+
+    QList<QList<ListItem*>> runs;
+    for (const auto& pair : items) {
+        ListItem* item = pair.second;
+        if (!runs.isEmpty()) {
+            ListItem* last = runs.last().last();
+            if (last->parent() == item->parent() && last->row() + 1 == item->row()) {
+                runs.last() << item;
+                continue;
             }
-            newParent->setExpanded(true);
-            return indexFromItem(item);
-        } else {
-            db.rollback();
-            return index;
         }
+        runs << QList<ListItem*>{item};
     }
+    return runs;
 }
 
-void ListModel::removeItem(const QModelIndex& index)
+// applies the same change to all the items, the views are notified once the whole batch is saved. Each item has its
+// own savepoint so a failed change is rolled back alone, the setters only change an item once it is saved. When the
+// transaction itself fails the changed items are put back as they were.
+void ListModel::updateItems(const QList<ListItem*>& items, const std::function<bool(ListItem*)>& update)
 {
-    if (!index.isValid())
+    QSqlDatabase db = QSqlDatabase::database();
+    if (!db.transaction()) {
+        emit operationError("Cannot start a transaction: " + db.lastError().text());
         return;
+    }
 
-    ListItem* item = itemFromIndex(index);
-    if (!item)
+    QList<QPair<ListItem*, ListItem::Attributes>> changed;
+    bool success = true;
+    SqlQuery sql;
+    for (ListItem* item : items) {
+        ListItem::Attributes attributes = item->attributes();
+        if (!sql.exec("SAVEPOINT update_item")) {
+            success = false;
+            break;
+        }
+        if (update(item)) {
+            changed << qMakePair(item, attributes);
+            success = sql.exec("RELEASE update_item");
+        } else
+            success = sql.exec("ROLLBACK TO update_item") && sql.exec("RELEASE update_item");
+        if (!success)
+            break;
+    }
+
+    if (success && db.commit()) {
+        for (const QPair<ListItem*, ListItem::Attributes>& pair : changed)
+            itemChanged(pair.first);
         return;
+    }
 
-    bool isProject = item->isProject();
+    QString error = db.lastError().text();
+    db.rollback();
+    for (int i = changed.length() - 1; i >= 0; --i) {
+        changed.at(i).first->restoreAttributes(changed.at(i).second);
+        repaintItem(changed.at(i).first);
+    }
+    emit operationError("Cannot save the changes: " + error);
+}
 
-    ListItem* parent = item->parent();
+// the rows are all deleted before the items are, nothing is removed from the views when the transaction fails
+void ListModel::removeItems(const QModelIndexList& indexes)
+{
+    QList<QList<ListItem*>> runs = _siblingRuns(indexes);
+
+    // disable removing the last children
+    int topCount = 0;
+    for (const QList<ListItem*>& run : runs)
+        if (run.first()->parent() == _root)
+            topCount += run.length();
+    if (runs.isEmpty() || (topCount > 0 && topCount == _root->childCount()))
+        return;
+
+    QSqlDatabase db = QSqlDatabase::database();
+    db.transaction();
+    bool success = true;
 
-    // disable removing the last child
-    if (parent == root() && root()->childCount() == 1)
+    // from the end so the rows of the remaining runs do not change
+    for (int i = runs.length() - 1; i >= 0 && success; --i) {
+        const QList<ListItem*>& run = runs.at(i);
+        success = _deleteRows(run.first()->parent(), run.first()->row(), run.length());
+    }
+
+    if (!success) {
+        db.rollback();
         return;
+    }
+    db.commit();
+
+    for (int i = runs.length() - 1; i >= 0; --i) {
+        const QList<ListItem*>& run = runs.at(i);
+        ListItem* parent = run.first()->parent();
+        beginRemoveRows(indexFromItem(parent), run.first()->row(), run.last()->row());
+        for (int j = run.length() - 1; j >= 0; --j)
+            _removeItem(run.at(j));
+        endRemoveRows();
+    }
+}
 
-    int row = item->row();
+// in tree order at the given row of the parent
+bool ListModel::moveItems(const QModelIndexList& indexes, const QModelIndex& parent, int row)
+{
+    ListItem* dstParent = itemFromIndex(parent);
+    QList<QList<ListItem*>> runs = _siblingRuns(indexes);
+    if (!dstParent || runs.isEmpty())
+        return false;
 
-    beginRemoveRows(indexFromItem(parent), row, row);
     QSqlDatabase db = QSqlDatabase::database();
     db.transaction();
-    if (_removeItem(item)) {
-        db.commit();
-        if (isProject)
-            emit projectRemoved();
-    } else {
-        db.rollback();
+
+    QList<MovedRun> moved;
+    bool success = true;
+    for (const QList<ListItem*>& run : runs) {
+        ListItem* srcParent = run.first()->parent();
+        int srcRow = run.first()->row();
+        int count = run.length();
+        bool isBefore = srcParent == dstParent && srcRow < row;
+        if (srcParent == dstParent && row >= srcRow && row <= srcRow + count) {
+            // already in place, the next run goes after it
+            row = srcRow + count;
+            continue;
+        }
+        if (!_canMoveRows(srcParent, srcRow, count, dstParent, row))
+            continue;
+        success = _moveRows(srcParent, srcRow, count, dstParent, row);
+        if (!success)
+            break;
+        moved << MovedRun{run.first(), count, srcParent, srcRow};
+        if (!isBefore)
+            row += count;
     }
-    endRemoveRows();
+
+    return _endMoves(moved, success);
 }
 
-bool ListModel::_removeItem(ListItem* item)
+// each run becomes the last children of the sibling before it
+bool ListModel::indentItems(const QModelIndexList& indexes)
 {
-    for (int i = item->childCount(); i > 0; --i)
-        _removeItem(item->child(i - 1));
+    QList<QList<ListItem*>> runs = _siblingRuns(indexes);
 
-    ListItem* parent = item->parent();
-    int id = item->id();
-    int row = item->row();
+    QSqlDatabase db = QSqlDatabase::database();
+    db.transaction();
+
+    QList<MovedRun> moved;
+    QList<ListItem*> newParents;
+    bool success = true;
+    for (int i = runs.length() - 1; i >= 0 && success; --i) {
+        const QList<ListItem*>& run = runs.at(i);
+        ListItem* parent = run.first()->parent();
+        int row = run.first()->row();
+        ListItem* newParent = parent->child(row - 1);
+        if (!newParent || !_canMoveRows(parent, row, run.length(), newParent, newParent->childCount()))
+            continue;
+        success = _moveRows(parent, row, run.length(), newParent, newParent->childCount());
+        if (success) {
+            moved << MovedRun{run.first(), run.length(), parent, row};
+            newParents << newParent;
+        }
+    }
+
+    if (!_endMoves(moved, success))
+        return false;
+    for (ListItem* newParent : newParents)
+        newParent->setExpanded(true);
+    return true;
+}
+
+// each run goes after its parent
+bool ListModel::outdentItems(const QModelIndexList& indexes)
+{
+    QList<QList<ListItem*>> runs = _siblingRuns(indexes);
+
+    QSqlDatabase db = QSqlDatabase::database();
+    db.transaction();
+
+    QList<MovedRun> moved;
+    bool success = true;
+    for (int i = runs.length() - 1; i >= 0 && success; --i) {
+        const QList<ListItem*>& run = runs.at(i);
+        ListItem* parent = run.first()->parent();
+        int row = run.first()->row();
+        if (parent->isRoot() || !_canMoveRows(parent, row, run.length(), parent->parent(), parent->row() + 1))
+            continue;
+        success = _moveRows(parent, row, run.length(), parent->parent(), parent->row() + 1);
+        if (success)
+            moved << MovedRun{run.first(), run.length(), parent, row};
+    }
+
+    return _endMoves(moved, success);
+}
+
+// moves the due dates of the item and its descendants by the same number of days
+bool ListModel::shiftDueDates(const QModelIndex& index, int days)
+{
+    ListItem* item = itemFromIndex(index);
+    if (!index.isValid() || !item || days == 0)
+        return false;
+
+    QSqlDatabase db = QSqlDatabase::database();
+    db.transaction();
 
     SqlQuery sql;
-    sql.prepare("UPDATE list_item SET weight = weight - 1 WHERE parent_id = :parent AND weight > :weight");
-    sql.bindValue(":parent", parent->id());
-    sql.bindValue(":weight", row);
-    if (!sql.exec())
+    sql.prepare("WITH RECURSIVE subtree(id) AS ("
+                "SELECT :id UNION ALL SELECT list_item.id FROM list_item JOIN subtree ON list_item.parent_id = subtree.id) "
+                "UPDATE list_item SET due_date = date(due_date, :days) WHERE due_date IS NOT NULL AND id IN subtree");
+    sql.bindValue(":id", item->id());
+    sql.bindValue(":days", QString("%1 days").arg(days));
+    if (!sql.exec()) {
+        db.rollback();
         return false;
+    }
+    db.commit();
+
+    _shiftDueDates(item, days);
+    return true;
+}
 
-    sql.prepare("DELETE FROM list_item WHERE id = :id");
-    sql.bindValue(":id", id);
+void ListModel::_shiftDueDates(ListItem* item, int days)
+{
+    if (item->dueDate().isValid()) {
+        item->applyDueDate(item->dueDate().addDays(days));
+        itemChanged(item);
+    }
+    for (int i = 0, n = item->childCount(); i < n; ++i)
+        _shiftDueDates(item->child(i), days);
+}
+
+// deletes count siblings with their subtrees, the search index and the tags follow through their triggers
+bool ListModel::_deleteRows(ListItem* parent, int row, int count)
+{
+    SqlQuery sql;
+    sql.prepare("WITH RECURSIVE subtree(id) AS ("
+                "SELECT id FROM list_item WHERE list_id = :list AND parent_id = :parent AND weight >= :row AND weight < :end "
+                "UNION ALL SELECT list_item.id FROM list_item JOIN subtree ON list_item.parent_id = subtree.id) "
+                "DELETE FROM list_item WHERE id IN subtree");
+    sql.bindValue(":list", _listId);
+    sql.bindValue(":parent", parent->id());
+    sql.bindValue(":row", row);
+    sql.bindValue(":end", row + count);
     if (!sql.exec())
         return false;
 
-    parent->removeChild(row);
+    sql.prepare("UPDATE list_item SET weight = weight - :count WHERE list_id = :list AND parent_id = :parent AND weight >= :end");
+    sql.bindValue(":count", count);
+    sql.bindValue(":list", _listId);
+    sql.bindValue(":parent", parent->id());
+    sql.bindValue(":end", row + count);
+    return sql.exec();
+}
+
+// the in memory part of a removal, the rows are already deleted
+void ListModel::_removeItem(ListItem* item)
+{
+    for (int i = item->childCount(); i > 0; --i)
+        _removeItem(item->child(i - 1));
+
+    int id = item->id();
+
+    if (item->dueDate().isValid())
+        emit scheduleRemoved(id);
+    if (!item->isCompleted() && !item->isCancelled())
+        DueDateCounts::instance()->add(item->dueDate(), -1);
+
+    _changedItems.remove(item);
+    _textIndex.remove(item);
+    for (ListFilter* filter : _filters)
+        filter->itemRemoved(item);
+    TagIndex::instance()->removeItem(id);
+    item->parent()->removeChild(item->row());
+}
+
+void ListModel::itemTextChanged(ListItem* item)
+{
+    _textIndex.update(item);
+    _updateFilters(item, false);
+}
+
+// repaints the columns computed from other items, without refiltering
+void ListModel::repaintItem(ListItem* item)
+{
+    _changedItems.insert(item);
+    if (!_changeTimer.isActive())
+        _changeTimer.start();
+}
+
+void ListModel::itemChanged(ListItem* item)
+{
+    _changedItems.insert(item);
+    if (!_changeTimer.isActive())
+        _changeTimer.start();
+
+    _applyFilters(item);
+}
+
+// repaint the items which became overdue, or stopped being overdue if the clock went back
+void ListModel::_changeDate(ListItem* parent, const QDate& from, const QDate& to)
+{
+    for (int i = 0, n = parent->childCount(); i < n; ++i) {
+        ListItem* item = parent->child(i);
+        // the progress column is coloured by the earliest due date of the subtree
+        const QDate& earliestDue = item->rollup().earliestDue;
+        if ((item->dueDate() >= from && item->dueDate() < to) || (earliestDue >= from && earliestDue < to))
+            _changedItems.insert(item);
+        _changeDate(item, from, to);
+    }
+    if (parent == _root && !_changedItems.isEmpty() && !_changeTimer.isActive())
+        _changeTimer.start();
+}
+
+// emit one dataChanged per range of adjacent changed rows
+void ListModel::_emitChanges()
+{
+    QHash<ListItem*, QList<int>> changedRows;
+    for (ListItem* item : _changedItems)
+        if (item->parent())
+            changedRows[item->parent()] << item->row();
+    _changedItems.clear();
+
+    const int lastColumn = columnCount() - 1;
+    for (auto it = changedRows.begin(); it != changedRows.end(); ++it) {
+        QModelIndex parent = indexFromItem(it.key());
+        QList<int>& rows = it.value();
+        std::sort(rows.begin(), rows.end());
+
+        int first = rows.first();
+        int last = first;
+        for (int i = 1, n = rows.length(); i <= n; ++i) {
+            if (i < n && rows.at(i) == last + 1) {
+                last = rows.at(i);
+                continue;
+            }
+            emit dataChanged(index(first, 0, parent), index(last, lastColumn, parent));
+            if (i < n)
+                first = last = rows.at(i);
+        }
+    }
+}
+
+void ListModel::addFilter(ListFilter* filter)
+{
+    if (_filters.contains(filter))
+        return;
+    _filters.append(filter);
+    _refilter(_root);
+}
+
+void ListModel::removeFilter(ListFilter* filter)
+{
+    if (!_filters.removeOne(filter))
+        return;
+    _refilter(_root);
+}
+
+bool ListModel::_acceptsItem(ListItem* item) const
+{
+    for (const ListFilter* filter : _filters)
+        if (!filter->accepts(item))
+            return false;
     return true;
 }
 
-void ListModel::itemChanged(ListItem* item, const QVector<int>& roles)
+// update the hidden state of a single item, e.g. after it has been completed
+void ListModel::_applyFilters(ListItem* item)
+{
+    if (item->isRoot())
+        return;
+
+    bool isHidden = !_acceptsItem(item);
+    if (isHidden == item->isFiltered())
+        return;
+
+    item->setFiltered(isHidden);
+    emit rowsHiddenChanged(item->row(), item->row(), indexFromItem(item->parent()), isHidden);
+
+    // the children state is not maintained while the item is hidden
+    if (!isHidden)
+        _refilter(item);
+}
+
+// lets the filters keeping state test one item again, then updates the rows whose state may have changed
+void ListModel::_updateFilters(ListItem* item, bool isNew)
 {
-    QModelIndex itemIndex = indexFromItem(item);
-    emit dataChanged(itemIndex, itemIndex, roles);
-    if (item->isProject() || item->isMilestone())
-        emit projectChanged(item);
+    QList<ListItem*> changed;
+    for (ListFilter* filter : _filters)
+        changed += isNew ? filter->itemAdded(item) : filter->itemChanged(item);
+    // the ancestors first since showing a row filters its children again
+    for (int i = changed.length() - 1; i >= 0; --i)
+        _applyFilters(changed.at(i));
+}
+
+// only rows whose state changes are reported, children of hidden rows are skipped since the view hides them anyway
+void ListModel::_refilter(ListItem* parent)
+{
+    // contiguous rows are reported as one run, once the whole parent is up to date
+    QList<QPair<int, int>> shown, hidden;
+    for (int i = 0, n = parent->childCount(); i < n; ++i) {
+        ListItem* child = parent->child(i);
+        bool isHidden = !_acceptsItem(child);
+        if (isHidden != child->isFiltered()) {
+            child->setFiltered(isHidden);
+            QList<QPair<int, int>>& runs = isHidden ? hidden : shown;
+            if (!runs.isEmpty() && runs.last().second == i - 1)
+                runs.last().second = i;
+            else
+                runs.append(qMakePair(i, i));
+        }
+        if (!isHidden && child->childCount() > 0)
+            _refilter(child);
+    }
+
+    if (shown.isEmpty() && hidden.isEmpty())
+        return;
+    QModelIndex parentIndex = indexFromItem(parent);
+    for (const QPair<int, int>& run : shown)
+        emit rowsHiddenChanged(run.first, run.second, parentIndex, false);
+    for (const QPair<int, int>& run : hidden)
+        emit rowsHiddenChanged(run.first, run.second, parentIndex, true);
 }
 
 bool ListModel::isNewItemCheckable(ListItem* parent, int row)
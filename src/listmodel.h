@@ -2,8 +2,14 @@
 
 #include "constants.h"
 #include "listitem.h"
+#include "listfilter.h"
+#include "trigramindex.h"
 
 #include <QAbstractItemModel>
+#include <QSet>
+#include <QTimer>
+
+#include <functional>
 
 class ListTree;
 
@@ -29,6 +35,14 @@ public:
 
     Qt::ItemFlags flags(const QModelIndex& index) const override;
 
+    // drag and drop inside a list moves the subtrees
+    Qt::DropActions supportedDropActions() const override { return Qt::MoveAction; };
+    QStringList mimeTypes() const override;
+    QMimeData* mimeData(const QModelIndexList& indexes) const override;
+    bool dropMimeData(const QMimeData* data, Qt::DropAction action, int row, int column, const QModelIndex& parent) override;
+    bool moveRows(const QModelIndex& sourceParent, int sourceRow, int count, const QModelIndex& destinationParent,
+                  int destinationChild) override;
+
     ListItem* itemFromIndex(const QModelIndex& index) const { return index.isValid() ? static_cast<ListItem*>(index.internalPointer()) : _root; };
     QModelIndex indexFromItem(ListItem* item) const { return item->isRoot() ? QModelIndex() : createIndex(item->row(), 0, item); };
     QModelIndex indexFromId(int itemId) const;
@@ -39,24 +53,69 @@ public:
 
     void sort(ListItem* parent, App::SortMode mode);
     QModelIndex moveItemVertical(const QModelIndex& index, App::Direction direction);
+    QModelIndex moveItemTo(const QModelIndex& index, int targetRow);
     QModelIndex moveItemHorizontal(const QModelIndex& index, int direction);
 
     void removeItem(const QModelIndex& index);
+    bool shiftDueDates(const QModelIndex& index, int days);
+
+    // bulk operations, each one runs in one transaction
+    void updateItems(const QList<ListItem*>& items, const std::function<bool(ListItem*)>& update);
+    void removeItems(const QModelIndexList& indexes);
+    bool moveItems(const QModelIndexList& indexes, const QModelIndex& parent, int row);
+    bool indentItems(const QModelIndexList& indexes);
+    bool outdentItems(const QModelIndexList& indexes);
 
-    void itemChanged(ListItem* item, const QVector<int>& roles = QVector<int>());
+    void itemChanged(ListItem* item);
+    void repaintItem(ListItem* item);
+    void itemTextChanged(ListItem* item); // content or tags
+    const TrigramIndex* textIndex() const { return &_textIndex; };
+
+    void addFilter(ListFilter* filter);
+    void removeFilter(ListFilter* filter);
+    bool hasFilter(const ListFilter* filter) const { return _filters.contains(const_cast<ListFilter*>(filter)); };
+    void refilter() { _refilter(_root); }; // after a filter changed its criteria
 
     static bool isNewItemCheckable(ListItem* parent, int row = 0);
 signals:
-    void projectAdded(ListItem* item);
-    void projectChanged(ListItem* item);
-    void projectRemoved();
-    void scheduleChanged();
+    void scheduleChanged(ListItem* item);
+    void scheduleRemoved(int itemId);
     void operationError(const QString& message);
+    void rowsHiddenChanged(int first, int last, const QModelIndex& parent, bool isHidden);
 private:
+    // a run moved inside a batch and where it was, to put it back when the batch fails
+    struct MovedRun
+    {
+        ListItem* first;
+        int count;
+        ListItem* parent;
+        int row;
+    };
+
     int _listId{0};
     ListItem* _root{nullptr};
+    QList<ListFilter*> _filters; // not owned
+    TrigramIndex _textIndex;
+
+    QSet<ListItem*> _changedItems;
+    QTimer _changeTimer;
 
     void _loadItems(ListItem* parent);
     QModelIndex _appendAfter(ListItem* item, const QString& content, App::AppendMode mode);
-    bool _removeItem(ListItem* item);
+    bool _deleteRows(ListItem* parent, int row, int count);
+    void _removeItem(ListItem* item);
+    bool _canMoveRows(ListItem* srcParent, int srcRow, int count, ListItem* dstParent, int dstRow) const;
+    bool _moveRows(ListItem* srcParent, int srcRow, int count, ListItem* dstParent, int dstRow);
+    void _moveChildren(ListItem* srcParent, int srcRow, int count, ListItem* dstParent, int dstRow);
+    bool _endMoves(const QList<MovedRun>& moved, bool success);
+    QList<QList<ListItem*>> _siblingRuns(const QModelIndexList& indexes) const;
+    void _findItems(ListItem* parent, QSet<int>& ids, QModelIndexList& indexes) const;
+    void _emitChanges();
+    void _changeDate(ListItem* parent, const QDate& from, const QDate& to);
+    void _shiftDueDates(ListItem* item, int days);
+
+    bool _acceptsItem(ListItem* item) const;
+    void _applyFilters(ListItem* item);
+    void _updateFilters(ListItem* item, bool isNew);
+    void _refilter(ListItem* parent);
 };
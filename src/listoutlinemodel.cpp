@@ -0,0 +1,57 @@
+#include "listoutlinemodel.h"
+
+#include "listmodel.h"
+
+ListOutlineModel::ListOutlineModel(QObject* parent) : QSortFilterProxyModel(parent)
+{
+    setDynamicSortFilter(true);
+}
+
+ListModel* ListOutlineModel::listModel() const
+{
+    return static_cast<ListModel*>(sourceModel());
+}
+
+void ListOutlineModel::setListModel(ListModel* model)
+{
+    if (model == listModel())
+        return;
+
+    // the list model repaints the items whose outline count goes from or to zero, the dynamic filter then
+    // inserts or removes only those rows
+    setSourceModel(model);
+}
+
+bool ListOutlineModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+    ListItem* item = listModel()->itemFromIndex(sourceParent)->child(sourceRow);
+    return item && item->hasOutline();
+}
+
+bool ListOutlineModel::filterAcceptsColumn(int sourceColumn, const QModelIndex& sourceParent) const
+{
+    Q_UNUSED(sourceParent);
+    return sourceColumn == 0;
+}
+
+QVariant ListOutlineModel::data(const QModelIndex& index, int role) const
+{
+    switch (role) {
+        case Qt::BackgroundRole:
+        case Qt::CheckStateRole:
+            return QVariant();
+    }
+    return QSortFilterProxyModel::data(index, role);
+}
+
+Qt::ItemFlags ListOutlineModel::flags(const QModelIndex& index) const
+{
+    return index.isValid() ? Qt::ItemIsEnabled | Qt::ItemIsSelectable : Qt::NoItemFlags;
+}
+
+QVariant ListOutlineModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && section == 0 && role == Qt::DisplayRole)
+        return "Outline";
+    return QVariant();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QSortFilterProxyModel>
+
+class ListModel;
+class ListItem;
+
+// Projects and milestones of a ListModel together with the items leading to them. The rows are the list model's
+// own items, mapToSource gives the index in the list tree.
+class ListOutlineModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    ListOutlineModel(QObject* parent = 0);
+
+    ListModel* listModel() const;
+    void setListModel(ListModel* model);
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+    bool filterAcceptsColumn(int sourceColumn, const QModelIndex& sourceParent) const override;
+};
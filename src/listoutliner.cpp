@@ -1,59 +1,28 @@
 #include "listoutliner.h"
-#include "sqlquery.h"
+#include "listmodel.h"
 
 #include <QDebug>
 
-MarkdownRenderer ListOutliner::_renderer{};
-
 ListOutliner::ListOutliner(QWidget* parent) : QWidget(parent)
 {
     _tree = new ListOutlinerTree(this);
 
+    _model = new ListOutlineModel(this);
+    _tree->setModel(_model);
+
     _layout = new QVBoxLayout(this);
     _layout->setContentsMargins(0, 0, 0, 0);
     _layout->addWidget(_tree);
-}
-
-void ListOutliner::loadOutline(int listId)
-{
-    if (listId == 0)
-        return;
-
-    _currentListId = listId;
 
-    _tree->clear();
-    _loadOutline();
-    _tree->expandAll();
+    // rows that pass the filter later are expanded like the initial outline
+    connect(_model, &ListOutlineModel::rowsInserted, [this](const QModelIndex& parent, int first, int last) {
+        for (int row = first; row <= last; ++row)
+            _tree->expand(_model->index(row, 0, parent));
+    });
 }
 
-void ListOutliner::reloadOutline()
+void ListOutliner::setListModel(ListModel* model)
 {
-    _tree->clear();
-    _loadOutline();
+    _model->setListModel(model);
     _tree->expandAll();
 }
-
-void ListOutliner::_loadOutline(int parentId, QTreeWidgetItem* parent)
-{
-    SqlQuery sql;
-    sql.prepare("SELECT id, content FROM list_item WHERE list_id = :list AND parent_id = :parent AND (is_project = 1 OR is_milestone = 1) ORDER BY weight ASC");
-    sql.bindValue(":list", _currentListId);
-    sql.bindValue(":parent", parentId);
-    if (!sql.exec())
-        return;
-    while (sql.next()) {
-        int c = -1;
-
-        int id = sql.value(++c).toInt();
-        QString content = sql.value(++c).toString();
-        QString markdown = _renderer.convert(content);
-
-        QTreeWidgetItem* item = new QTreeWidgetItem(QStringList(markdown));
-        item->setData(0, Qt::UserRole, id);
-        if (!parent)
-            _tree->addTopLevelItem(item);
-        else
-            parent->addChild(item);
-        _loadOutline(id, item);
-    }
-}
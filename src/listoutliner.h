@@ -1,10 +1,9 @@
 #pragma once
 
 #include "listoutlinertree.h"
-#include "markdownrenderer.h"
+#include "listoutlinemodel.h"
 
 #include <QWidget>
-#include <QTreeWidget>
 #include <QVBoxLayout>
 
 class ListOutliner : public QWidget
@@ -14,15 +13,10 @@ public:
     ListOutliner(QWidget* parent = 0);
     QSize sizeHint() const { return QSize(80, QWidget::sizeHint().height()); };
     ListOutlinerTree* tree() const { return _tree; };
-public slots:
-    void loadOutline(int listId);
-    void reloadOutline();
+    ListOutlineModel* model() const { return _model; };
+    void setListModel(ListModel* model);
 private:
     QVBoxLayout* _layout{nullptr};
     ListOutlinerTree* _tree{nullptr};
-    int _currentListId{0};
-
-    static MarkdownRenderer _renderer;
-
-    void _loadOutline(int parentId = 0, QTreeWidgetItem* parent = 0);
+    ListOutlineModel* _model{nullptr};
 };
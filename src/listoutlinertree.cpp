@@ -6,44 +6,40 @@
 #include <QApplication>
 
 ListOutlinerTree::ListOutlinerTree(QWidget* parent)
-    : QTreeWidget(parent),
+    : QTreeView(parent),
       _preventItemClicked(false)
 {
-    setColumnCount(1);
-    setHeaderLabel("Outline");
     setExpandsOnDoubleClick(false);
     setAlternatingRowColors(true);
 
     _delegate = new ListOutlinerItemDelegate(this);
     setItemDelegateForColumn(0, _delegate);
 
-    connect(this, &QTreeWidget::itemClicked, [this](QTreeWidgetItem* item, int column) {
-        QDEBUG;
-        if (!_preventItemClicked) {
-            QDEBUG << column;
-            emit itemClickedAlt(item, column);
-        }
+    connect(this, &QTreeView::clicked, [this](const QModelIndex& index) {
+        if (!_preventItemClicked)
+            emit clickedAlt(index);
     });
 
-    connect(this, &QTreeWidget::itemDoubleClicked, [this](QTreeWidgetItem* item, int column) {
+    connect(this, &QTreeView::doubleClicked, [this](const QModelIndex& index) {
         _preventItemClicked = true;
-        emit itemDoubleClickedAlt(item, column);
+        emit doubleClickedAlt(index);
         QTimer::singleShot(QApplication::doubleClickInterval(), [this]() {
             _preventItemClicked = false;
         });
     });
 
     _resizeTimer.setSingleShot(true);
-    connect(&_resizeTimer, &QTimer::timeout, this, &QTreeWidget::doItemsLayout);
+    connect(&_resizeTimer, &QTimer::timeout, this, &QTreeView::doItemsLayout);
 }
 
 void ListOutlinerTree::adjustDelegate() const
 {
-    emit _delegate->sizeHintChanged(indexFromItem(invisibleRootItem()->child(0)));
+    if (model())
+        emit _delegate->sizeHintChanged(model()->index(0, 0));
 }
 
 void ListOutlinerTree::resizeEvent(QResizeEvent* event)
 {
     _resizeTimer.start(125);
-    QTreeWidget::resizeEvent(event);
+    QTreeView::resizeEvent(event);
 }
@@ -2,10 +2,10 @@
 
 #include "listoutlineritemdelegate.h"
 
-#include <QTreeWidget>
+#include <QTreeView>
 #include <QTimer>
 
-class ListOutlinerTree : public QTreeWidget
+class ListOutlinerTree : public QTreeView
 {
     Q_OBJECT
 public:
@@ -13,8 +13,8 @@ public:
 public slots:
     void adjustDelegate() const;
 signals:
-    void itemClickedAlt(QTreeWidgetItem* item, int column);
-    void itemDoubleClickedAlt(QTreeWidgetItem* item, int column);
+    void clickedAlt(const QModelIndex& index);
+    void doubleClickedAlt(const QModelIndex& index);
 protected:
     void resizeEvent(QResizeEvent* event);
 private:
@@ -2,6 +2,7 @@
 
 #include "listmodel.h"
 #include "listitemeditdialog.h"
+#include "badgedelegate.h"
 #include "constants.h"
 #include "utils.h"
 #include "debug.h"
@@ -17,18 +18,32 @@
 ListTree::ListTree(int listId, QWidget* parent) : QTreeView(parent), _listId(listId)
 {
     _itemDelegate = new ListItemDelegate(this);
+    _itemDelegate->setPixmapCacheEnabled(true);
 
     setAlternatingRowColors(true);
-    setSelectionMode(QAbstractItemView::SingleSelection);
+    setSelectionMode(QAbstractItemView::ExtendedSelection);
+    setDragDropMode(QAbstractItemView::InternalMove);
+    setDefaultDropAction(Qt::MoveAction);
+    setDropIndicatorShown(true);
     setItemDelegateForColumn(0, _itemDelegate);
+    setItemDelegateForColumn(2, new BadgeDelegate(this));
 
     ListModel* model = new ListModel(listId, this);
     setModel(model);
+    connect(model, &ListModel::rowsHiddenChanged, this, &ListTree::_setRowsHidden);
+    // show the items dropped into a collapsed parent
+    connect(model, &ListModel::rowsMoved, this, [this](const QModelIndex&, int, int, const QModelIndex& destination) {
+        if (destination.isValid() && this->model()->itemFromIndex(destination)->isExpanded())
+            expand(destination);
+    });
+    // the expansion done to show the text filter matches is not saved
     connect(this, &ListTree::expanded, [this](const QModelIndex& index) {
-        this->model()->itemFromIndex(index)->setExpanded(true);
+        if (!this->model()->hasFilter(&_textFilter))
+            this->model()->itemFromIndex(index)->setExpanded(true);
     });
     connect(this, &ListTree::collapsed, [this](const QModelIndex& index) {
-        this->model()->itemFromIndex(index)->setExpanded(false);
+        if (!this->model()->hasFilter(&_textFilter))
+            this->model()->itemFromIndex(index)->setExpanded(false);
     });
 
     restoreExpandedState(model->root());
@@ -39,6 +54,7 @@ ListTree::ListTree(int listId, QWidget* parent) : QTreeView(parent), _listId(lis
     // header->resizeSection(0, 250);
     header->setSectionResizeMode(0, QHeaderView::Stretch);
     header->resizeSection(1, 60);
+    header->resizeSection(2, 50);
 
     _resizeTimer.setSingleShot(true);
     connect(&_resizeTimer, &QTimer::timeout, this, &ListTree::doItemsLayout);
@@ -54,6 +70,22 @@ ListItem* ListTree::currentItem() const
     return model()->itemFromIndex(currentIndex());
 }
 
+QModelIndexList ListTree::selectedRows() const
+{
+    QModelIndexList rows = selectionModel()->selectedRows();
+    if (rows.isEmpty() && currentIndex().isValid())
+        rows << currentIndex().sibling(currentIndex().row(), 0);
+    return rows;
+}
+
+QList<ListItem*> ListTree::selectedItems() const
+{
+    QList<ListItem*> items;
+    for (const QModelIndex& index : selectedRows())
+        items << model()->itemFromIndex(index);
+    return items;
+}
+
 ListItem* ListTree::rootItem() const
 {
     return model()->itemFromIndex(rootIndex());
@@ -97,10 +129,9 @@ bool ListTree::_itemKeyPress(ListItem* item, int key, Qt::KeyboardModifiers modi
         case Qt::Key_1:
         case Qt::Key_2:
         case Qt::Key_3:
-            if (item->setPriority(key - 0x30)) { // Key_1 = 0x31
-                model->itemChanged(item);
-                viewport()->repaint();
-            }
+            model->updateItems(selectedItems(), [key](ListItem* selected) {
+                return selected->setPriority(key - 0x30); // Key_1 = 0x31
+            });
             return true;
         case Qt::Key_A: // append
             if (modifiers & Qt::ShiftModifier)
@@ -111,41 +142,55 @@ bool ListTree::_itemKeyPress(ListItem* item, int key, Qt::KeyboardModifiers modi
         case Qt::Key_B: // append child
             _appendItem(App::AppendChild);
             return true;
-        case Qt::Key_C: // checkable
-            item->setCheckable(!item->isCheckable());
-            model->itemChanged(item);
+        case Qt::Key_C: { // checkable, the selected items follow the current one
+            bool isCheckable = !item->isCheckable();
+            model->updateItems(selectedItems(), [isCheckable](ListItem* selected) { return selected->setCheckable(isCheckable); });
             return true;
+        }
         case Qt::Key_D: // delete
         case Qt::Key_Delete:
-            remove(currentIndex());
+            _removeSelected();
             return true;
-        case Qt::Key_Space: // toggle checkbox
-            item->setCompleted(!item->isCompleted());
-            model->itemChanged(item);
+        case Qt::Key_Space: { // toggle checkbox
+            bool isCompleted = !item->isCompleted();
+            model->updateItems(selectedItems(), [isCompleted](ListItem* selected) { return selected->setCompleted(isCompleted); });
             return true;
+        }
         case Qt::Key_E:
         case Qt::Key_F2:
             edit(currentIndex());
             return true;
-        case Qt::Key_M:
-            item->setMilestone(!item->isMilestone());
-            model->itemChanged(item);
+        case Qt::Key_M: {
+            bool isMilestone = !item->isMilestone();
+            model->updateItems(selectedItems(), [isMilestone](ListItem* selected) { return selected->setMilestone(isMilestone); });
             return true;
-        case Qt::Key_P: // toggle project
-            item->setProject(!item->isProject());
-            model->itemChanged(item);
+        }
+        case Qt::Key_P: { // toggle project
+            bool isProject = !item->isProject();
+            model->updateItems(selectedItems(), [isProject](ListItem* selected) { return selected->setProject(isProject); });
             return true;
-        case Qt::Key_X: // cancel item
-            item->setCancelled(!item->isCancelled());
-            model->itemChanged(item);
+        }
+        case Qt::Key_X: { // cancel item
+            bool isCancelled = !item->isCancelled();
+            model->updateItems(selectedItems(), [isCancelled](ListItem* selected) { return selected->setCancelled(isCancelled); });
             return true;
-        case Qt::Key_H: // highlight
-            item->setHighlighted(!item->isHighlighted());
-            model->itemChanged(item);
+        }
+        case Qt::Key_H: { // highlight
+            bool isHighlighted = !item->isHighlighted();
+            model->updateItems(selectedItems(), [isHighlighted](ListItem* selected) { return selected->setHighlighted(isHighlighted); });
             return true;
+        }
         case Qt::Key_S: // sort
             model->sort(item, App::SortByStatus);
             return true;
+        case Qt::Key_BracketLeft: // shift the due dates of the subtree by a day, or a week with shift
+        case Qt::Key_BracketRight:
+        case Qt::Key_BraceLeft:
+        case Qt::Key_BraceRight: {
+            int days = modifiers & Qt::ShiftModifier ? 7 : 1;
+            model->shiftDueDates(currentIndex(), key == Qt::Key_BracketLeft || key == Qt::Key_BraceLeft ? -days : days);
+            return true;
+        }
         case Qt::Key_Z: // zoom
             if (modifiers == Qt::ShiftModifier)
                 unzoom();
@@ -255,30 +300,34 @@ void ListTree::_moveVertical(App::Direction direction)
     ListModel* model = this->model();
 
     QModelIndex parent = curr.parent();
-    int nchild = model->itemFromIndex(parent)->childCount();
+    ListItem* parentItem = model->itemFromIndex(parent);
     int row = curr.row();
     int newRow = row + offset;
-    while (isRowHidden(newRow, parent)) {
+    ListItem* sibling = nullptr;
+    while ((sibling = parentItem->child(newRow)) && sibling->isFiltered())
         newRow += offset;
-        if (newRow == 0 || newRow == nchild) // all other rows are hidden
-            return;
-    }
-
-    QDEBUG << row << newRow;
-
-    QModelIndex newIndex;
-    while (row != newRow) {
-        newIndex = model->moveItemVertical(curr, direction);
-        QDEBUG << row << newIndex;
-        row += offset;
-    }
+    if (!sibling) // all other rows are hidden
+        return;
 
+    // past the hidden siblings in one move
+    QModelIndex newIndex = model->moveItemTo(curr, newRow);
     setCurrentIndex(newIndex);
     restoreExpandedState(parent);
 }
 
 void ListTree::_moveHorizontal(int dir)
 {
+    // several items are indented or outdented together
+    QModelIndexList rows = selectedRows();
+    if (rows.length() > 1) {
+        ListModel* model = this->model();
+        QList<ListItem*> items = selectedItems();
+        if (dir == App::Left ? model->outdentItems(rows) : model->indentItems(rows))
+            for (ListItem* item : items)
+                restoreExpandedState(dir == App::Left ? item : item->parent());
+        return;
+    }
+
     QModelIndex curr = currentIndex();
 
     if (!curr.isValid())
@@ -355,6 +404,22 @@ void ListTree::remove(const QModelIndex& index)
         model()->removeItem(index);
 }
 
+void ListTree::_removeSelected()
+{
+    QModelIndexList rows = selectedRows();
+    if (rows.length() <= 1) {
+        remove(currentIndex());
+        return;
+    }
+
+    QMessageBox mbox;
+    mbox.setText(QString("<b>Do you want to remove these %1 items?</b>").arg(rows.length()));
+    mbox.setIcon(QMessageBox::Warning);
+    mbox.setStandardButtons(QMessageBox::Ok | QMessageBox::Cancel);
+    if (mbox.exec() == QMessageBox::Ok)
+        model()->removeItems(rows);
+}
+
 void ListTree::edit(const QModelIndex& index)
 {
     if (!index.isValid())
@@ -364,20 +429,10 @@ void ListTree::edit(const QModelIndex& index)
     if (!item)
         return;
 
-    QDate maxDueDate;
-    ListItem* parent = item->parent();
-    while (parent) {
-        if (!parent->dueDate().isNull()) {
-            maxDueDate = parent->dueDate();
-            break;
-        }
-        parent = parent->parent();
-    }
-
     ListItemEditDialog dialog(QApplication::activeWindow(), QStringLiteral("Edit Item %0").arg(item->id()));
     dialog.setText(item->markdown());
     dialog.setDueDate(item->dueDate());
-    dialog.setMaxDueDate(maxDueDate);
+    dialog.setMaxDueDate(item->deadline());
 
     if (dialog.exec() == QDialog::Accepted) {
         item->setMarkdown(dialog.text());
@@ -411,7 +466,7 @@ void ListTree::zoom(const QModelIndex& index)
         return;
 
     if (item->childCount() == 0 && !item->isProject()) { // no zoom for leaf node
-        scrollTo(item->id());
+        scrollToIndex(index);
         return;
     }
 
@@ -473,6 +528,34 @@ bool ListTree::isZoomed() const
     return rootIndex() != model()->indexFromItem(model()->root());
 }
 
+void ListTree::dataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles)
+{
+    QModelIndex parent = topLeft.parent();
+    QRegion region;
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        // one index at a time so QTreeView refreshes its height cache without updating the whole viewport
+        QModelIndex index = model()->index(row, 0, parent);
+        QTreeView::dataChanged(index, index, roles);
+        region += _rowDamage(index);
+    }
+    if (!region.isEmpty())
+        viewport()->update(region);
+}
+
+// the whole row plus the branch area of the visible descendants, where the priority bar of the item is drawn
+QRegion ListTree::_rowDamage(const QModelIndex& index) const
+{
+    QRect rect = visualRect(index);
+    if (rect.isEmpty())
+        return QRegion();
+
+    const int width = viewport()->width();
+    QRegion region(0, rect.top(), width, rect.height());
+    if (isExpanded(index) && model()->rowCount(index) > 0)
+        region += QRect(0, rect.bottom() + 1, rect.left() + indentation(), viewport()->height() - rect.bottom());
+    return region;
+}
+
 void ListTree::resizeEvent(QResizeEvent* event)
 {
     _resizeTimer.start(125);
@@ -562,11 +645,17 @@ void ListTree::scrollTo(int itemId)
     if (itemId == 0)
         return;
 
-    QModelIndex leftIndex = model()->indexFromId(itemId);
+    scrollToIndex(model()->indexFromId(itemId));
+}
+
+// scroll the item to the top and select it
+void ListTree::scrollToIndex(const QModelIndex& index)
+{
     // index not found
-    if (!leftIndex.isValid())
+    if (!index.isValid())
         return;
 
+    QModelIndex leftIndex = index.sibling(index.row(), 0);
     QModelIndex rightIndex = leftIndex.sibling(leftIndex.row(), model()->columnCount(leftIndex));
 
     QTreeView::scrollTo(leftIndex, QAbstractItemView::PositionAtTop);
@@ -575,50 +664,74 @@ void ListTree::scrollTo(int itemId)
     selection->select(QItemSelection(leftIndex, rightIndex), QItemSelectionModel::Select);
 }
 
-void ListTree::hideCompleted()
+void ListTree::setTextFilter(const QString& text)
 {
-    if (_isHidingCompleted)
+    ListModel* model = this->model();
+    bool isFiltering = model->hasFilter(&_textFilter);
+    _textFilter.setText(text, model);
+
+    if (text.isEmpty()) {
+        if (isFiltering) {
+            model->removeFilter(&_textFilter);
+            restoreExpandedState();
+        }
         return;
-    _hideCompletedRows();
-    _isHidingCompleted = true;
+    }
+
+    if (isFiltering)
+        model->refilter();
+    else
+        model->addFilter(&_textFilter);
+
+    for (ListItem* item : _textFilter.ancestors())
+        expand(model->indexFromItem(item));
 }
 
-void ListTree::_hideCompletedRows(ListItem* parent)
+void ListTree::hideCompleted()
 {
-    ListModel* model = this->model();
-    if (!parent)
-        parent = model->root();
-    QModelIndex parentIndex = model->indexFromItem(parent);
-    for (int n = parent->childCount() - 1; n >= 0; --n) {
-        ListItem* child = parent->child(n);
-        if (child->isCompleted() || child->isCancelled())
-            setRowHidden(child->row(), parentIndex, true);
-        else if (child->childCount() > 0)
-            _hideCompletedRows(child);
-    }
+    model()->addFilter(&_completedFilter);
 }
 
 void ListTree::showCompleted()
 {
-    if (!_isHidingCompleted)
+    model()->removeFilter(&_completedFilter);
+}
+
+// one line per item, lets QTreeView skip the per row size hints
+void ListTree::setCompact(bool isCompact)
+{
+    if (isCompact == _isCompact)
         return;
-    _showCompletedRows();
-    _isHidingCompleted = false;
+    _isCompact = isCompact;
+    setUniformRowHeights(isCompact);
+    doItemsLayout();
 }
 
-void ListTree::_showCompletedRows(ListItem* parent)
+void ListTree::_setRowsHidden(int first, int last, const QModelIndex& parent, bool isHidden)
 {
-    ListModel* model = this->model();
-    if (!parent)
-        parent = model->root();
-    QModelIndex parentIndex = model->indexFromItem(parent);
-    for (int i = 0, n = parent->childCount(); i < n; ++i) {
-        ListItem* child = parent->child(i);
-        if (isRowHidden(child->row(), parentIndex))
-            setRowHidden(child->row(), parentIndex, false);
-        else if (child->childCount() > 0)
-            _showCompletedRows(child);
-    }
+    QModelIndex current = currentIndex();
+    bool isCurrent = isHidden && current.parent() == parent && current.row() >= first && current.row() <= last;
+
+    for (int row = first; row <= last; ++row)
+        setRowHidden(row, parent, isHidden);
+
+    if (!isCurrent)
+        return;
+
+    // keep the cursor on a visible row, prefer the next sibling
+    ListItem* parentItem = model()->itemFromIndex(parent);
+    ListItem* sibling = nullptr;
+    for (int i = last + 1, n = parentItem->childCount(); i < n && !sibling; ++i)
+        if (!parentItem->child(i)->isFiltered())
+            sibling = parentItem->child(i);
+    for (int i = first - 1; i >= 0 && !sibling; --i)
+        if (!parentItem->child(i)->isFiltered())
+            sibling = parentItem->child(i);
+
+    if (sibling)
+        setCurrentIndex(model()->indexFromItem(sibling));
+    else if (parent != rootIndex())
+        setCurrentIndex(parent);
 }
 
 int ListTree::_newItemRow(const QModelIndex& parent)
@@ -635,7 +748,7 @@ int ListTree::_newItemRow(const QModelIndex& parent)
 
     --pos;
     ListItem* child = nullptr;
-    while (isRowHidden(pos, parent) || (child = item->child(pos), child->isCompleted() || child->isCancelled())) {
+    while ((child = item->child(pos), child->isFiltered() || child->isCompleted() || child->isCancelled())) {
         --pos;
         if (pos < 0) // all child hidden
             return 0;
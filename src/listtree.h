@@ -9,6 +9,7 @@
 #include "listwidget.h"
 #include "listitem.h"
 #include "listitemdelegate.h"
+#include "listfilter.h"
 
 class ListTree : public QTreeView
 {
@@ -36,13 +37,22 @@ public:
     bool isZoomed() const;
 
     void scrollTo(int itemId);
+    void scrollToIndex(const QModelIndex& index);
 
     ListItem* currentItem() const;
+    QModelIndexList selectedRows() const; // the current item if nothing is selected
+    QList<ListItem*> selectedItems() const;
     ListItem* rootItem() const;
 
-    bool isHidingCompleted() const { return _isHidingCompleted; };
+    bool isHidingCompleted() const { return model()->hasFilter(&_completedFilter); };
     void hideCompleted();
     void showCompleted();
+
+    QString textFilter() const { return _textFilter.text(); };
+    void setTextFilter(const QString& text);
+
+    bool isCompact() const { return _isCompact; };
+    void setCompact(bool isCompact);
 public slots:
     void unzoomTo(const QModelIndex& index);
     void unzoomAll();
@@ -50,6 +60,7 @@ signals:
     void zoomed(ListItem* item);
     void unzoomed();
 protected:
+    void dataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles = QVector<int>()) override;
     void resizeEvent(QResizeEvent* event) override;
     void drawBranches(QPainter *painter, const QRect &rect, const QModelIndex &index) const override;
 private:
@@ -57,15 +68,18 @@ private:
     ListItemDelegate* _itemDelegate{nullptr};
     QTimer _resizeTimer;
 
-    bool _isHidingCompleted{false};
+    CompletedFilter _completedFilter;
+    TextFilter _textFilter;
+    bool _isCompact{false};
 
     void _appendItem(App::AppendMode mode);
     void _moveVertical(App::Direction direction);
     void _moveHorizontal(int dir);
+    void _removeSelected();
     bool _itemKeyPress(ListItem* item, int key, Qt::KeyboardModifiers modifiers);
-    void _hideCompletedRows(ListItem* parent = 0);
-    void _showCompletedRows(ListItem* parent = 0);
+    void _setRowsHidden(int first, int last, const QModelIndex& parent, bool isHidden);
 
+    QRegion _rowDamage(const QModelIndex& index) const;
     void _drawPriorityBar(ListItem* item, QPainter* painter, const QRect& rect, int x, int gap = 0) const;
     int _newItemRow(const QModelIndex& parent);
 };
@@ -2,14 +2,22 @@
 #include "listtree.h"
 #include "listoutliner.h"
 #include "breadcrumb.h"
+#include "smartfilter.h"
+#include "smartfilterview.h"
+#include "sqlquery.h"
+#include "tagindex.h"
 #include "debug.h"
 
 #include <QAction>
 #include <QTabWidget>
 #include <QVBoxLayout>
+#include <QHBoxLayout>
 #include <QSqlQuery>
 #include <QDebug>
 #include <QStandardItem>
+#include <QInputDialog>
+#include <QMessageBox>
+#include <QMenu>
 
 ListWidget::ListWidget(QWidget* parent) : QWidget(parent)
 {
@@ -22,26 +30,63 @@ ListWidget::ListWidget(QWidget* parent) : QWidget(parent)
     _splitter->addWidget(_outliner);
     _splitter->addWidget(_tabWidget);
 
+    _filterEdit = new QLineEdit(this);
+    _filterEdit->setPlaceholderText("Filter");
+    _filterEdit->setClearButtonEnabled(true);
+
+    // tags by number of items, choosing one filters on it
+    _tagsButton = new QToolButton(this);
+    _tagsButton->setText("Tags");
+    _tagsButton->setPopupMode(QToolButton::InstantPopup);
+    _tagsButton->setMenu(new QMenu(_tagsButton));
+    connect(_tagsButton->menu(), &QMenu::aboutToShow, [this]() {
+        QMenu* menu = _tagsButton->menu();
+        menu->clear();
+        for (const QPair<QString, int>& count : TagIndex::instance()->counts()) {
+            QString tag = count.first;
+            connect(menu->addAction(QString("%1 (%2)").arg(tag).arg(count.second)), &QAction::triggered,
+                    [this, tag]() { _filterEdit->setText(tag); });
+        }
+        if (menu->isEmpty())
+            menu->addAction("No tags")->setEnabled(false);
+    });
+
+    auto filterLayout = new QHBoxLayout;
+    filterLayout->setContentsMargins(0, 0, 0, 0);
+    filterLayout->addWidget(_filterEdit);
+    filterLayout->addWidget(_tagsButton);
+
     _layout = new QVBoxLayout(this);
     _layout->setContentsMargins(0, 0, 0, 0);
+    _layout->addLayout(filterLayout);
     _layout->addWidget(_splitter);
 
-    // update outline when changing list
-    connect(this, &ListWidget::listSelected, _outliner, &ListOutliner::loadOutline);
+    // update outline and filter when changing list
+    connect(_tabWidget, &QTabWidget::currentChanged, [this]() {
+        ListTree* tree = currentTree();
+        _outliner->setListModel(tree ? tree->model() : nullptr);
+        if (tree)
+            tree->setTextFilter(_filterEdit->text());
+    });
+
+    // filter as you type
+    connect(_filterEdit, &QLineEdit::textChanged, [this](const QString& text) {
+        ListTree* tree = currentTree();
+        if (tree)
+            tree->setTextFilter(text);
+    });
 
     // click on outline
-    connect(_outliner->tree(), &ListOutlinerTree::itemClickedAlt, [this](QTreeWidgetItem* item, int column) {
-        if (column == 0)
-            if (isZoomed())
-                zoomTo(item->data(0, Qt::UserRole).toInt());
-            else
-                scrollTo(item->data(0, Qt::UserRole).toInt());
+    connect(_outliner->tree(), &ListOutlinerTree::clickedAlt, [this](const QModelIndex& index) {
+        if (isZoomed())
+            zoomTo(_outliner->model()->mapToSource(index));
+        else
+            scrollTo(_outliner->model()->mapToSource(index));
     });
 
     // double click on outline
-    connect(_outliner->tree(), &ListOutlinerTree::itemDoubleClickedAlt, [this](QTreeWidgetItem* item, int column) {
-        if (column == 0)
-            zoomTo(item->data(0, Qt::UserRole).toInt());
+    connect(_outliner->tree(), &ListOutlinerTree::doubleClickedAlt, [this](const QModelIndex& index) {
+        zoomTo(_outliner->model()->mapToSource(index));
     });
 }
 
@@ -54,6 +99,7 @@ void ListWidget::loadLists()
         int listId = sql.value(0).toInt();
 
         ListTree* tree = new ListTree(listId, this);
+        tree->setCompact(_isCompact);
         _trees.append(tree);
 
         Breadcrumb* breadcrumb = new Breadcrumb(this);
@@ -92,11 +138,13 @@ void ListWidget::loadLists()
         });
 
         ListModel* model = tree->model();
-        connect(model, &ListModel::projectRemoved, _outliner, &ListOutliner::reloadOutline);
-        connect(model, &ListModel::projectChanged, _outliner, &ListOutliner::reloadOutline);
-        connect(model, &ListModel::projectAdded, _outliner, &ListOutliner::reloadOutline);
         connect(model, &ListModel::scheduleChanged, this, &ListWidget::scheduleChanged);
+        connect(model, &ListModel::scheduleRemoved, this, &ListWidget::scheduleRemoved);
         connect(model, &ListModel::operationError, this, &ListWidget::operationError);
+        connect(model, &ListModel::dataChanged, this, &ListWidget::_invalidateSmartFilters);
+        connect(model, &ListModel::rowsInserted, this, &ListWidget::_invalidateSmartFilters);
+        connect(model, &ListModel::rowsRemoved, this, &ListWidget::_invalidateSmartFilters);
+        connect(model, &ListModel::rowsMoved, this, &ListWidget::_invalidateSmartFilters);
 
         auto widget = new QWidget;
         auto layout = new QVBoxLayout;
@@ -111,7 +159,88 @@ void ListWidget::loadLists()
         emit listSelected(listId);
     }
 
-    if (nlist == 1)
+    _loadSmartFilters();
+
+    if (_tabWidget->count() == 1)
+        _tabWidget->tabBar()->hide();
+}
+
+void ListWidget::_loadSmartFilters()
+{
+    QSqlQuery sql("SELECT id, name, query FROM smart_filter ORDER BY weight ASC");
+    while (sql.next())
+        _addSmartFilterView(sql.value(0).toInt(), sql.value(1).toString(), sql.value(2).toString());
+}
+
+void ListWidget::_addSmartFilterView(int filterId, const QString& name, const QString& query)
+{
+    SmartFilterView* view = new SmartFilterView(filterId, query, this);
+    connect(view, &SmartFilterView::itemSelected, [this](int listId, int itemId) { showItem(listId, itemId); });
+    _smartFilters.append(view);
+    _tabWidget->addTab(view, name);
+}
+
+// any change of a list can change the results
+void ListWidget::_invalidateSmartFilters()
+{
+    for (SmartFilterView* view : _smartFilters)
+        view->invalidate();
+}
+
+void ListWidget::addSmartFilter()
+{
+    bool ok = false;
+    QString name = QInputDialog::getText(this, "New Smart Filter", "Name:", QLineEdit::Normal, QString(), &ok).trimmed();
+    if (!ok || name.isEmpty())
+        return;
+
+    QString query;
+    for (;;) {
+        query = QInputDialog::getText(this, "New Smart Filter",
+                                      "Filter (for example: priority:1 due:week, highlighted project:\"Name\", "
+                                      "completed_at>=-30d):",
+                                      QLineEdit::Normal, query, &ok);
+        if (!ok)
+            return;
+        SmartFilter filter(query);
+        if (filter.isValid())
+            break;
+        QMessageBox::warning(this, "Error", filter.error());
+    }
+
+    SqlQuery sql;
+    sql.prepare("INSERT INTO smart_filter (name, query, weight) "
+                "VALUES (:name, :query, (SELECT COALESCE(MAX(weight) + 1, 0) FROM smart_filter))");
+    sql.bindValue(":name", name);
+    sql.bindValue(":query", query);
+    if (!sql.exec())
+        return;
+
+    _addSmartFilterView(sql.lastInsertId().toInt(), name, query);
+    _tabWidget->tabBar()->show();
+    _tabWidget->setCurrentWidget(_smartFilters.last());
+}
+
+void ListWidget::removeSmartFilter()
+{
+    SmartFilterView* view = qobject_cast<SmartFilterView*>(_tabWidget->currentWidget());
+    if (!view)
+        return;
+
+    QString name = _tabWidget->tabText(_tabWidget->currentIndex());
+    if (QMessageBox::question(this, "Delete Smart Filter", QString("Delete the smart filter \"%1\"?").arg(name)) !=
+        QMessageBox::Yes)
+        return;
+
+    SqlQuery sql;
+    sql.prepare("DELETE FROM smart_filter WHERE id = :id");
+    sql.bindValue(":id", view->filterId());
+    if (!sql.exec())
+        return;
+
+    _smartFilters.removeOne(view);
+    view->deleteLater();
+    if (_tabWidget->count() == 2)
         _tabWidget->tabBar()->hide();
 }
 
@@ -151,11 +280,50 @@ void ListWidget::scrollTo(int itemId)
     ListTree* tree = currentTree();
     if (!tree)
         return;
+    scrollTo(tree->model()->indexFromId(itemId));
+}
+
+// index of the current tree model
+void ListWidget::scrollTo(const QModelIndex& index)
+{
+    ListTree* tree = currentTree();
+    if (!tree || !index.isValid())
+        return;
     tree->unzoomAll();
-    tree->scrollTo(itemId);
+    tree->scrollToIndex(index);
     tree->setFocus(Qt::MouseFocusReason);
 }
 
+// switch to the list of the item and scroll to it
+void ListWidget::showItem(int listId, int itemId, bool isZoom)
+{
+    for (int i = 0; i < _trees.length(); ++i)
+        if (_trees.at(i)->listId() == listId) {
+            _tabWidget->setCurrentIndex(i);
+            _unfilter(_trees.at(i), itemId);
+            if (isZoom)
+                zoomTo(itemId);
+            else
+                scrollTo(itemId);
+            return;
+        }
+}
+
+// the filters hiding the item are turned off, the jump would not be visible otherwise
+void ListWidget::_unfilter(ListTree* tree, int itemId)
+{
+    auto isHidden = [tree, itemId]() {
+        for (ListItem* item = tree->model()->itemFromId(itemId); item && !item->isRoot(); item = item->parent())
+            if (item->isFiltered())
+                return true;
+        return false;
+    };
+    if (isHidden() && !_filterEdit->text().isEmpty())
+        _filterEdit->clear();
+    if (isHidden())
+        tree->showCompleted();
+}
+
 void ListWidget::zoomTo(int itemId)
 {
     // invalid id
@@ -164,8 +332,16 @@ void ListWidget::zoomTo(int itemId)
     ListTree* tree = currentTree();
     if (!tree)
         return;
+    zoomTo(tree->model()->indexFromId(itemId));
+}
+
+void ListWidget::zoomTo(const QModelIndex& index)
+{
+    ListTree* tree = currentTree();
+    if (!tree || !index.isValid())
+        return;
     tree->unzoomAll();
-    tree->zoom(itemId);
+    tree->zoom(index);
     tree->setFocus(Qt::MouseFocusReason);
 }
 
@@ -194,6 +370,17 @@ void ListWidget::toggleHideCompleted()
         menuItem->setChecked(isHidden ? false : true);
 }
 
+void ListWidget::toggleCompact()
+{
+    _isCompact = !_isCompact;
+    for (ListTree* tree : _trees)
+        tree->setCompact(_isCompact);
+
+    QAction* menuItem = dynamic_cast<QAction*>(sender());
+    if (menuItem && menuItem->isCheckable())
+        menuItem->setChecked(_isCompact);
+}
+
 void ListWidget::expandAll()
 {
     ListTree* tree = currentTree();
@@ -4,9 +4,13 @@
 #include <QTabWidget>
 #include <QSplitter>
 #include <QVBoxLayout>
+#include <QLineEdit>
+#include <QToolButton>
 
+class ListItem;
 class ListTree;
 class ListOutliner;
+class SmartFilterView;
 
 class ListWidget : public QWidget
 {
@@ -20,18 +24,34 @@ public:
     bool isZoomed() const;
 public slots:
     void scrollTo(int itemId);
+    void scrollTo(const QModelIndex& index);
     void zoomTo(int itemId);
+    void zoomTo(const QModelIndex& index);
+    void showItem(int listId, int itemId, bool isZoom = false);
     void toggleHideCompleted();
+    void toggleCompact();
     void expandAll();
     void collapseAll();
+    void addSmartFilter();
+    void removeSmartFilter();
 signals:
     void listSelected(int listId);
-    void scheduleChanged();
+    void scheduleChanged(ListItem* item);
+    void scheduleRemoved(int itemId);
     void operationError(const QString& message);
 private:
     QVBoxLayout* _layout{nullptr};
     QSplitter* _splitter{nullptr};
     ListOutliner* _outliner{nullptr};
     QTabWidget* _tabWidget{nullptr};
+    QLineEdit* _filterEdit{nullptr};
+    QToolButton* _tagsButton{nullptr};
     QList<ListTree*> _trees;
+    bool _isCompact{false}; // applied to the trees created later too
+    QList<SmartFilterView*> _smartFilters; // tabs after the lists
+
+    void _unfilter(ListTree* tree, int itemId);
+    void _loadSmartFilters();
+    void _addSmartFilterView(int filterId, const QString& name, const QString& query);
+    void _invalidateSmartFilters();
 };
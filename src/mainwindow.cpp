@@ -32,6 +32,7 @@ MainWindow::MainWindow() : QMainWindow()
 
     _list = new ListWidget(this);
     _schedule = new ScheduleWidget(this);
+    _agenda = new AgendaView(this);
     _statusBar = statusBar();
     _tabs = new QTabWidget(this);
 
@@ -55,15 +56,29 @@ void MainWindow::_setupMenu()
     menu->addAction("Exit", this, SLOT(close()));
 
     menu = menuBar->addMenu("&List");
+    menu->addAction("&Search...", this, SLOT(showSearchDialog()), QKeySequence::Find);
+    menu->addAction("&Quick Jump...", this, SLOT(showQuickJumpDialog()), QKeySequence("Ctrl+P"));
+    menu->addSeparator();
     action = menu->addAction("&Hide Completed", _list, SLOT(toggleHideCompleted()));
     action->setCheckable(true);
     action->setChecked(true);
+    action = menu->addAction("Co&mpact Mode", _list, SLOT(toggleCompact()));
+    action->setCheckable(true);
 
     menu->addSeparator();
 
     menu->addAction("&Expand All", _list, SLOT(expandAll()));
     menu->addAction("&Collapse All", _list, SLOT(collapseAll()));
 
+    menu->addSeparator();
+
+    menu->addAction("New Smart &Filter...", _list, SLOT(addSmartFilter()));
+    menu->addAction("&Delete Smart Filter", _list, SLOT(removeSmartFilter()));
+
+    menu = menuBar->addMenu("Sc&hedule");
+    action = menu->addAction("Show &Archive", _schedule, SLOT(toggleArchive()));
+    action->setCheckable(true);
+
     menu = menuBar->addMenu("&Help");
     menu->addAction("&About", this, SLOT(showAboutDialog()));
     menu->addAction("About &Qt", this, SLOT(showAboutQtDialog()));
@@ -75,11 +90,15 @@ void MainWindow::_setupUi()
     connect(_list, &ListWidget::operationError, [this](const QString& message) {
         _statusBar->showMessage(message, 5000);
     });
-    connect(_list, &ListWidget::scheduleChanged, _schedule, &ScheduleWidget::reload);
+    connect(_list, &ListWidget::scheduleChanged, _schedule, &ScheduleWidget::updateTask);
+    connect(_list, &ListWidget::scheduleRemoved, _schedule, &ScheduleWidget::removeTask);
+    connect(_list, &ListWidget::scheduleChanged, _agenda->model(), &AgendaModel::updateTask);
+    connect(_list, &ListWidget::scheduleRemoved, _agenda->model(), &AgendaModel::removeTask);
 
     _tabs->setStyleSheet("QTabWidget::pane { padding-bottom: 0 }");
     _tabs->addTab(_list, Util::findIcon("list"), "&Tasks");
     _tabs->addTab(_schedule, Util::findIcon("schedule"), "&Schedule");
+    _tabs->addTab(_agenda, Util::findIcon("schedule"), "&Agenda");
     setCentralWidget(_tabs);
 }
 
@@ -132,6 +151,34 @@ void MainWindow::showAboutDialog()
     aboutDialog.exec();
 }
 
+void MainWindow::showSearchDialog()
+{
+    if (!_searchDialog) {
+        _searchDialog = new SearchDialog(this);
+        connect(_searchDialog, &SearchDialog::itemSelected, [this](int listId, int itemId) {
+            _tabs->setCurrentWidget(_list);
+            _list->showItem(listId, itemId);
+        });
+    }
+    _searchDialog->show();
+    _searchDialog->raise();
+    _searchDialog->activateWindow();
+}
+
+void MainWindow::showQuickJumpDialog()
+{
+    if (!_quickJumpDialog) {
+        _quickJumpDialog = new QuickJumpDialog(_list, this);
+        connect(_quickJumpDialog, &QuickJumpDialog::itemSelected, [this](int listId, int itemId, bool isZoom) {
+            _tabs->setCurrentWidget(_list);
+            _list->showItem(listId, itemId, isZoom);
+        });
+    }
+    _quickJumpDialog->show();
+    _quickJumpDialog->raise();
+    _quickJumpDialog->activateWindow();
+}
+
 void MainWindow::showAboutQtDialog()
 {
     QApplication::aboutQt();
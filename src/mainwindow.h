@@ -7,6 +7,9 @@
 
 #include "listwidget.h"
 #include "schedulewidget.h"
+#include "agendaview.h"
+#include "searchdialog.h"
+#include "quickjumpdialog.h"
 
 class MainWindow : public QMainWindow
 {
@@ -19,6 +22,8 @@ public:
 public slots:
     void showAboutDialog();
     void showAboutQtDialog();
+    void showSearchDialog();
+    void showQuickJumpDialog();
 private:
     bool _menuVisible{false};
     bool _statusBarVisible{false};
@@ -26,6 +31,9 @@ private:
     QTabWidget* _tabs{nullptr};
     ListWidget* _list{nullptr};
     ScheduleWidget* _schedule{nullptr};
+    AgendaView* _agenda{nullptr};
+    SearchDialog* _searchDialog{nullptr};
+    QuickJumpDialog* _quickJumpDialog{nullptr};
     QStatusBar* _statusBar{nullptr};
 
     void _setupMenu();
@@ -1,6 +1,8 @@
 #include "markdownrenderer.h"
 
+#include <QCache>
 #include <QDebug>
+#include <QTextDocument>
 
 static const int html_flags = HOEDOWN_HTML_USE_XHTML;
 static const int enabled_exts = HOEDOWN_EXT_TABLES | HOEDOWN_EXT_FENCED_CODE | HOEDOWN_EXT_FOOTNOTES |
@@ -30,3 +32,22 @@ QString MarkdownRenderer::convert(const QString& input) const
     hoedown_buffer_free(html);
     return result;
 }
+
+MarkdownRenderer::Rendered MarkdownRenderer::render(const QString& markdown)
+{
+    static const MarkdownRenderer renderer;
+    static QCache<QString, Rendered> cache(16384);
+
+    Rendered* rendered = cache.object(markdown);
+    if (!rendered) {
+        rendered = new Rendered;
+        rendered->html = renderer.convert(markdown);
+
+        QTextDocument doc;
+        doc.setHtml(rendered->html);
+        rendered->text = doc.toPlainText();
+
+        cache.insert(markdown, rendered);
+    }
+    return *rendered;
+}
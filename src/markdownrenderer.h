@@ -9,9 +9,18 @@
 class MarkdownRenderer
 {
 public:
+    struct Rendered
+    {
+        QString html;
+        QString text;
+    };
+
     MarkdownRenderer();
     ~MarkdownRenderer();
     QString convert(const QString& input) const;
+
+    // process wide cache keyed by the markdown, the same text is rendered once for all items and views
+    static Rendered render(const QString& markdown);
 private:
     hoedown_renderer* renderer{nullptr};
     hoedown_document* document{nullptr};
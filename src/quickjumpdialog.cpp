@@ -0,0 +1,130 @@
+#include "quickjumpdialog.h"
+#include "htmldelegate.h"
+#include "listwidget.h"
+#include "listtree.h"
+
+#include <QApplication>
+#include <QKeyEvent>
+
+QuickJumpDialog::QuickJumpDialog(ListWidget* lists, QWidget* parent) : QDialog(parent), _lists(lists)
+{
+    setWindowIcon(QIcon(":app.png"));
+    setWindowTitle("Quick Jump");
+
+    _queryEdit = new QLineEdit(this);
+    _queryEdit->setPlaceholderText("Jump to item");
+    _queryEdit->installEventFilter(this);
+
+    _results = new QListWidget(this);
+    _results->setItemDelegate(new HtmlDelegate(_results));
+    _results->setUniformItemSizes(true);
+
+    _layout = new QVBoxLayout(this);
+    _layout->addWidget(_queryEdit);
+    _layout->addWidget(_results);
+
+    _index = new QuickJumpIndex(this);
+    for (ListTree* tree : lists->trees())
+        _index->addModel(tree->model());
+
+    qRegisterMetaType<QVector<QuickJumpCandidate>>();
+    qRegisterMetaType<QList<QuickJumpMatch>>();
+    _worker = new QuickJumpWorker;
+    _worker->moveToThread(&_thread);
+    connect(&_thread, &QThread::finished, _worker, &QObject::deleteLater);
+    connect(this, &QuickJumpDialog::searchRequested, _worker, &QuickJumpWorker::search);
+    connect(_worker, &QuickJumpWorker::matchesFound, this, &QuickJumpDialog::_showMatches);
+    _thread.start();
+
+    connect(_queryEdit, &QLineEdit::textChanged, this, &QuickJumpDialog::_search);
+    connect(_results, &QListWidget::itemActivated, [this](QListWidgetItem* item) { _select(item, false); });
+    connect(_results, &QListWidget::itemClicked, [this]() { _isRowChosen = true; });
+}
+
+QuickJumpDialog::~QuickJumpDialog()
+{
+    _worker->setGeneration(-1);
+    _thread.quit();
+    _thread.wait();
+}
+
+QSize QuickJumpDialog::sizeHint() const
+{
+    return QSize(500, 400);
+}
+
+void QuickJumpDialog::showEvent(QShowEvent* event)
+{
+    _queryEdit->selectAll();
+    _queryEdit->setFocus();
+    QDialog::showEvent(event);
+}
+
+// up and down in the query box move through the results, enter scrolls to the item and ctrl+enter zooms on it
+bool QuickJumpDialog::eventFilter(QObject* object, QEvent* event)
+{
+    if (object == _queryEdit && event->type() == QEvent::KeyPress) {
+        QKeyEvent* keyEvent = static_cast<QKeyEvent*>(event);
+        int key = keyEvent->key();
+        if (key == Qt::Key_Up || key == Qt::Key_Down || key == Qt::Key_PageUp || key == Qt::Key_PageDown) {
+            _isRowChosen = true;
+            QApplication::sendEvent(_results, event);
+            return true;
+        }
+        if (key == Qt::Key_Return || key == Qt::Key_Enter) {
+            _select(_results->currentItem(), keyEvent->modifiers() & Qt::ControlModifier);
+            return true;
+        }
+    }
+    return QDialog::eventFilter(object, event);
+}
+
+// results of older searches are ignored, the worker stops them at its next batch
+void QuickJumpDialog::_search(const QString& text)
+{
+    ++_generation;
+    _worker->setGeneration(_generation);
+    _isRowChosen = false;
+
+    QString query = text.toLower().remove(QRegExp("\\s+"));
+    if (query.isEmpty()) {
+        _results->clear();
+        return;
+    }
+    emit searchRequested(_generation, _index->candidates(), query);
+}
+
+void QuickJumpDialog::_showMatches(int generation, const QList<QuickJumpMatch>& matches, bool isFinished)
+{
+    if (generation != _generation)
+        return;
+
+    // the current result stays current between the batches, the best match is only taken once the search is
+    // finished and if the user did not pick another one
+    QListWidgetItem* current = _results->currentItem();
+    int currentId = current ? current->data(Qt::UserRole).toInt() : 0;
+    int currentRow = -1;
+
+    _results->setUpdatesEnabled(false);
+    _results->clear();
+    for (int i = 0, n = matches.length(); i < n; ++i) {
+        const QuickJumpMatch& match = matches.at(i);
+        QListWidgetItem* item = new QListWidgetItem(match.html, _results);
+        item->setData(Qt::UserRole, match.itemId);
+        item->setData(Qt::UserRole + 1, match.listId);
+        if (match.itemId == currentId)
+            currentRow = i;
+    }
+    if (currentRow < 0 || (isFinished && !_isRowChosen))
+        currentRow = 0;
+    _results->setCurrentRow(currentRow);
+    _results->setUpdatesEnabled(true);
+}
+
+void QuickJumpDialog::_select(QListWidgetItem* item, bool isZoom)
+{
+    if (!item)
+        return;
+    emit itemSelected(item->data(Qt::UserRole + 1).toInt(), item->data(Qt::UserRole).toInt(), isZoom);
+    hide();
+}
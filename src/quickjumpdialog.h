@@ -0,0 +1,42 @@
+#pragma once
+
+#include "quickjumpindex.h"
+#include "quickjumpworker.h"
+
+#include <QDialog>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QVBoxLayout>
+#include <QThread>
+
+class ListWidget;
+
+// Ctrl+P palette, fuzzy matches the labels of the items of all lists
+class QuickJumpDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    QuickJumpDialog(ListWidget* lists, QWidget* parent = 0);
+    ~QuickJumpDialog();
+    QSize sizeHint() const;
+    bool eventFilter(QObject* object, QEvent* event);
+protected:
+    void showEvent(QShowEvent* event);
+signals:
+    void itemSelected(int listId, int itemId, bool isZoom);
+    void searchRequested(int generation, const QVector<QuickJumpCandidate>& candidates, const QString& query);
+private:
+    ListWidget* _lists{nullptr};
+    QVBoxLayout* _layout{nullptr};
+    QLineEdit* _queryEdit{nullptr};
+    QListWidget* _results{nullptr};
+    QuickJumpIndex* _index{nullptr};
+    QuickJumpWorker* _worker{nullptr};
+    QThread _thread;
+    int _generation{0};
+    bool _isRowChosen{false}; // moved by the user since the query changed
+
+    void _search(const QString& text);
+    void _showMatches(int generation, const QList<QuickJumpMatch>& matches, bool isFinished);
+    void _select(QListWidgetItem* item, bool isZoom);
+};
@@ -0,0 +1,78 @@
+#include "quickjumpindex.h"
+#include "listmodel.h"
+
+void QuickJumpIndex::addModel(ListModel* model)
+{
+    for (int i = 0, n = model->root()->childCount(); i < n; ++i)
+        _insert(model->root()->child(i));
+
+    connect(model, &ListModel::rowsInserted, this, [this, model](const QModelIndex& parent, int first, int last) {
+        ListItem* parentItem = model->itemFromIndex(parent);
+        for (int row = first; row <= last; ++row)
+            _insert(parentItem->child(row));
+    });
+    connect(model, &ListModel::rowsAboutToBeRemoved, this,
+            [this, model](const QModelIndex& parent, int first, int last) {
+        ListItem* parentItem = model->itemFromIndex(parent);
+        for (int row = first; row <= last; ++row)
+            _remove(parentItem->child(row));
+    });
+    connect(model, &ListModel::dataChanged, this,
+            [this, model](const QModelIndex& topLeft, const QModelIndex& bottomRight) {
+        ListItem* parentItem = model->itemFromIndex(topLeft.parent());
+        for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+            _update(parentItem->child(row));
+    });
+}
+
+// with the descendants
+void QuickJumpIndex::_insert(ListItem* item)
+{
+    if (!item || _positions.contains(item))
+        return;
+
+    _positions[item] = _candidates.length();
+    _candidates.append({item->listId(), item->id(), item->label(), item->label().toLower()});
+    _items.append(item);
+
+    for (int i = 0, n = item->childCount(); i < n; ++i)
+        _insert(item->child(i));
+}
+
+// the last candidate takes the place of the removed one
+void QuickJumpIndex::_remove(ListItem* item)
+{
+    if (!item)
+        return;
+
+    for (int i = 0, n = item->childCount(); i < n; ++i)
+        _remove(item->child(i));
+
+    auto it = _positions.find(item);
+    if (it == _positions.end())
+        return;
+    int position = it.value();
+    _positions.erase(it);
+
+    int last = _candidates.length() - 1;
+    if (position != last) {
+        _candidates[position] = _candidates.at(last);
+        _items[position] = _items.at(last);
+        _positions[_items.at(position)] = position;
+    }
+    _candidates.removeLast();
+    _items.removeLast();
+}
+
+void QuickJumpIndex::_update(ListItem* item)
+{
+    auto it = _positions.find(item);
+    if (it == _positions.end())
+        return;
+
+    QuickJumpCandidate& candidate = _candidates[it.value()];
+    if (candidate.label == item->label())
+        return;
+    candidate.label = item->label();
+    candidate.key = candidate.label.toLower();
+}
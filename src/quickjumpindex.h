@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QModelIndex>
+
+class ListItem;
+class ListModel;
+
+struct QuickJumpCandidate
+{
+    int listId;
+    int itemId;
+    QString label;
+    QString key; // lower case label
+};
+
+// Labels of the items of all lists, kept up to date with the models so a search only has to score them.
+// The candidates are copied to the scoring thread, the copy is cheap until the index changes.
+class QuickJumpIndex : public QObject
+{
+    Q_OBJECT
+public:
+    QuickJumpIndex(QObject* parent = 0) : QObject(parent) {};
+
+    void addModel(ListModel* model);
+    QVector<QuickJumpCandidate> candidates() const { return _candidates; };
+private:
+    QVector<QuickJumpCandidate> _candidates;
+    QVector<ListItem*> _items; // same order as the candidates
+    QHash<ListItem*, int> _positions;
+
+    void _insert(ListItem* item);
+    void _remove(ListItem* item);
+    void _update(ListItem* item);
+};
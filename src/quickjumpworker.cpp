@@ -0,0 +1,73 @@
+#include "quickjumpworker.h"
+
+#include <algorithm>
+
+// the query characters must appear in order, runs and starts of words count more, short labels are preferred
+int QuickJumpWorker::score(const QuickJumpCandidate& candidate, const QString& query, QString* html)
+{
+    const QString& key = candidate.key;
+    const QString& label = candidate.label;
+    if (query.length() > key.length())
+        return -1;
+
+    QVector<int> positions;
+    positions.reserve(query.length());
+    int score = 0;
+    int previous = -2;
+    for (int i = 0, j = 0, n = key.length(); i < n && j < query.length(); ++i) {
+        if (key.at(i) != query.at(j))
+            continue;
+        int bonus = 1;
+        if (i == previous + 1)
+            bonus += 5;
+        if (i == 0 || !label.at(i - 1).isLetterOrNumber())
+            bonus += 8;
+        else if (label.at(i).isUpper() && label.at(i - 1).isLower())
+            bonus += 6;
+        score += bonus;
+        previous = i;
+        positions << i;
+        ++j;
+    }
+    if (positions.length() < query.length())
+        return -1;
+    score -= (key.length() - query.length()) / 8;
+
+    if (html) {
+        html->clear();
+        int last = 0;
+        for (int position : positions) {
+            *html += label.mid(last, position - last).toHtmlEscaped() + QStringLiteral("<b>") +
+                     QString(label.at(position)).toHtmlEscaped() + QStringLiteral("</b>");
+            last = position + 1;
+        }
+        *html += label.mid(last).toHtmlEscaped();
+    }
+    return score;
+}
+
+void QuickJumpWorker::search(int generation, const QVector<QuickJumpCandidate>& candidates, const QString& query)
+{
+    auto isBetter = [](const QuickJumpMatch& a, const QuickJumpMatch& b) { return a.score > b.score; };
+    QList<QuickJumpMatch> matches;
+    for (int i = 0, n = candidates.length(); i < n; ++i) {
+        if (i % _batchSize == 0 && i > 0) {
+            if (_generation.load() != generation)
+                return;
+            emit matchesFound(generation, matches, false);
+        }
+
+        const QuickJumpCandidate& candidate = candidates.at(i);
+        int score = QuickJumpWorker::score(candidate, query);
+        if (score < 0 || (matches.length() == _limit && score <= matches.last().score))
+            continue;
+
+        QuickJumpMatch match{candidate.listId, candidate.itemId, score, QString()};
+        QuickJumpWorker::score(candidate, query, &match.html);
+        matches.insert(std::upper_bound(matches.begin(), matches.end(), match, isBetter), match);
+        if (matches.length() > _limit)
+            matches.removeLast();
+    }
+    if (_generation.load() == generation)
+        emit matchesFound(generation, matches, true);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "quickjumpindex.h"
+
+#include <QObject>
+#include <QAtomicInt>
+
+struct QuickJumpMatch
+{
+    int listId;
+    int itemId;
+    int score;
+    QString html; // label with the matched characters in bold
+};
+
+Q_DECLARE_METATYPE(QVector<QuickJumpCandidate>)
+Q_DECLARE_METATYPE(QList<QuickJumpMatch>)
+
+// Fuzzy scoring of the quick jump candidates, lives in its own thread. A search stops as soon as a newer one is
+// requested, the best matches so far are sent back after every batch of candidates.
+class QuickJumpWorker : public QObject
+{
+    Q_OBJECT
+public:
+    QuickJumpWorker(QObject* parent = 0) : QObject(parent) {};
+
+    // called from the gui thread before queueing the search
+    void setGeneration(int generation) { _generation.store(generation); };
+
+    static int score(const QuickJumpCandidate& candidate, const QString& query, QString* html = nullptr);
+public slots:
+    void search(int generation, const QVector<QuickJumpCandidate>& candidates, const QString& query);
+signals:
+    void matchesFound(int generation, const QList<QuickJumpMatch>& matches, bool isFinished);
+private:
+    QAtomicInt _generation{0};
+    int _limit{50};
+    int _batchSize{4096};
+};
@@ -1,20 +1,20 @@
 #include "scheduleitem.h"
+#include "markdownrenderer.h"
 
 #include <QDebug>
 
-ScheduleItem::ScheduleItem() : _type(ScheduleItem::Root), _content("_root") {}
+ScheduleItem::ScheduleItem() : _type(ScheduleItem::Root), _content("_root"), _html(_content) {}
 
-ScheduleItem::ScheduleItem(int value, int type, const QString& display) : _type(type)
+ScheduleItem::ScheduleItem(int type, const QDate& date) : _type(type), _dueDate(date)
 {
-    if (display.isNull())
-        _content = QStringLiteral("<b>") + QString::number(value) + QStringLiteral("</b>");
-    else
-        _content = QStringLiteral("<b>") + display + QStringLiteral("</b>");
-}
-
-ScheduleItem::ScheduleItem(const QDate& date) : _type(ScheduleItem::Day), _dueDate(date)
-{
-    _content = QStringLiteral("<b>") + date.toString("dd") + QStringLiteral("</b>");
+    QString display;
+    switch (type) {
+        case ScheduleItem::Year: display = QString::number(date.year()); break;
+        case ScheduleItem::Month: display = date.toString("MMMM"); break;
+        case ScheduleItem::Day: display = date.toString("dd"); break;
+    }
+    _content = QStringLiteral("<b>") + display + QStringLiteral("</b>");
+    _html = _content;
 }
 
 ScheduleItem::ScheduleItem(int id, const QString& content, const QDate& dueDate, bool isCheckable, bool isCompleted)
@@ -25,16 +25,56 @@ ScheduleItem::ScheduleItem(int id, const QString& content, const QDate& dueDate,
       _isCheckable(isCheckable),
       _isCompleted(isCompleted)
 {
+    _html = MarkdownRenderer::render(content).html;
 }
 
 ScheduleItem::~ScheduleItem() { qDeleteAll(_children); }
 
+void ScheduleItem::setContent(const QString& content)
+{
+    if (content == _content)
+        return;
+    _content = content;
+    _html = MarkdownRenderer::render(content).html;
+}
+
 void ScheduleItem::appendChild(ScheduleItem* item)
 {
     item->setParent(this, _children.length());
     _children.append(item);
 }
 
+void ScheduleItem::insertChild(int row, ScheduleItem* item)
+{
+    for (int i = row, n = _children.length(); i < n; ++i)
+        _children.at(i)->_row += 1;
+    item->setParent(this, row);
+    _children.insert(row, item);
+}
+
+ScheduleItem* ScheduleItem::takeChild(int row)
+{
+    if (!(row >= 0 && row < _children.length()))
+        return nullptr;
+    for (int i = row + 1, n = _children.length(); i < n; ++i)
+        _children.at(i)->_row -= 1;
+    ScheduleItem* item = _children.takeAt(row);
+    item->setParent(nullptr, 0);
+    return item;
+}
+
+// children are ordered by date, tasks of the same day by id
+int ScheduleItem::childRow(const QDate& date, int id) const
+{
+    int row = 0;
+    for (int n = _children.length(); row < n; ++row) {
+        ScheduleItem* child = _children.at(row);
+        if (child->dueDate() > date || (child->dueDate() == date && child->id() >= id))
+            break;
+    }
+    return row;
+}
+
 ScheduleItem* ScheduleItem::child(int row) const
 {
     if (row >= 0 && row < _children.length())
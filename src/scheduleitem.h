@@ -5,24 +5,27 @@
 #include <QList>
 #include <QDebug>
 
+#include "dateclock.h"
+
 class ScheduleItem
 {
 public:
     ScheduleItem(); // root
-    ScheduleItem(int value, int type, const QString& content = QString()); // year/months
-    ScheduleItem(const QDate& dueDate); // day
+    ScheduleItem(int type, const QDate& date); // year/month/day, date is the first day of the period
     ScheduleItem(int id, const QString& content, const QDate& dueDate, bool isCheckable, bool isCompleted); // task
     ~ScheduleItem();
 
     int id() const { return _id; };
+    int type() const { return _type; };
     bool isRoot() const { return _type == ScheduleItem::Root; };
-    bool isToday() const { return _type == ScheduleItem::Day && _dueDate == QDate::currentDate(); };
+    bool isToday() const { return _type == ScheduleItem::Day && _dueDate == DateClock::instance()->today(); };
 
     QString content() const { return _content; };
-    void setContent(const QString& content) { _content = content; };
-    QString html() const { return _content; }; // TODO
+    void setContent(const QString& content);
+    QString html() const { return _html; };
 
     QDate dueDate() const { return _dueDate; };
+    void setDueDate(const QDate& dueDate) { _dueDate = dueDate; };
 
     ScheduleItem* parent() const { return _parent; };
     void setParent(ScheduleItem* parent, int row) { _parent = parent; _row = row; };
@@ -31,11 +34,20 @@ public:
     void setRow(int row) { _row = row; };
 
     bool isCheckable() const { return _type == ScheduleItem::Task && _isCheckable; };
+    void setCheckable(bool isCheckable) { _isCheckable = isCheckable; };
     bool isCompleted() const { return _type == ScheduleItem::Task && _isCompleted; };
+    void setCompleted(bool isCompleted) { _isCompleted = isCompleted; };
+
+    // months are fetched from the database when they are first expanded
+    bool isFetched() const { return _isFetched; };
+    void setFetched(bool isFetched) { _isFetched = isFetched; };
 
     void appendChild(ScheduleItem* item);
+    void insertChild(int row, ScheduleItem* item);
+    ScheduleItem* takeChild(int row);
     int childCount() const { return _children.length(); }
     ScheduleItem* child(int row) const;
+    int childRow(const QDate& date, int id = 0) const;
 
     void clear();
 
@@ -44,12 +56,14 @@ private:
     int _id{0};
     bool _isCheckable{false};
     bool _isCompleted{false};
+    bool _isFetched{true};
     int _type{0};
     int _row{0};
 
     ScheduleItem* _parent{nullptr};
 
     QString _content;
+    QString _html;
     QDate _dueDate;
     QList<ScheduleItem*> _children;
 };
@@ -1,6 +1,7 @@
 #include "schedulemodel.h"
 
 #include "sqlquery.h"
+#include "listitem.h"
 
 #include <QColor>
 #include <QDebug>
@@ -8,7 +9,9 @@
 ScheduleModel::ScheduleModel(QObject* parent) : QAbstractItemModel(parent)
 {
     _root = new ScheduleItem();
-    _loadItems();
+    reload();
+
+    connect(DateClock::instance(), &DateClock::dateChanged, this, &ScheduleModel::_changeDate);
 }
 
 ScheduleModel::~ScheduleModel()
@@ -16,16 +19,54 @@ ScheduleModel::~ScheduleModel()
     delete _root;
 }
 
+// only the months are loaded up front, their tasks are fetched on demand except for the next few months
 void ScheduleModel::_loadItems()
 {
     SqlQuery sql;
-    sql.prepare("SELECT id, content, due_date, is_checkable, is_completed FROM list_item WHERE due_date IS NOT NULL AND is_cancelled = 0 ORDER BY due_date ASC");
+    sql.prepare("SELECT DISTINCT substr(due_date, 1, 7) FROM list_item WHERE due_date IS NOT NULL AND is_cancelled = 0" +
+                _archiveCondition());
+    if (!_isArchiveShown)
+        sql.bindValue(":today", DateClock::instance()->today().toString(Qt::ISODate));
+    if (!sql.exec())
+        return;
+
+    QList<ScheduleItem*> months;
+    while (sql.next()) {
+        QDate date = QDate::fromString(sql.value(0).toString() + "-01", Qt::ISODate);
+        if (!date.isValid())
+            continue;
+        ScheduleItem* year = _findChild(_root, ScheduleItem::Year, QDate(date.year(), 1, 1));
+        ScheduleItem* month = _findChild(year, ScheduleItem::Month, date);
+        month->setFetched(false);
+        months << month;
+    }
+
+    QDate today = DateClock::instance()->today();
+    QDate firstEager(today.year(), today.month(), 1);
+    QDate lastEager = firstEager.addMonths(_eagerMonths);
+    for (auto month : months)
+        if (month->dueDate() >= firstEager && month->dueDate() < lastEager)
+            _fetchMonth(month);
+
+    for (int i = 0; i < _emptyDays; ++i)
+        _findDay(today.addDays(i));
+}
+
+void ScheduleModel::_fetchMonth(ScheduleItem* month)
+{
+    month->setFetched(true);
+
+    QDate first = month->dueDate();
+    SqlQuery sql;
+    sql.prepare("SELECT id, content, due_date, is_checkable, is_completed FROM list_item WHERE due_date >= :first AND "
+                "due_date < :next AND is_cancelled = 0" + _archiveCondition() + " ORDER BY due_date ASC, id ASC");
+    sql.bindValue(":first", first.toString(Qt::ISODate));
+    sql.bindValue(":next", first.addMonths(1).toString(Qt::ISODate));
+    if (!_isArchiveShown)
+        sql.bindValue(":today", DateClock::instance()->today().toString(Qt::ISODate));
     if (!sql.exec())
         return;
 
-    QList<ScheduleItem*> items;
-    QDate minDate;
-    QDate maxDate;
     while (sql.next()) {
         int c = -1;
 
@@ -35,47 +76,213 @@ void ScheduleModel::_loadItems()
         bool isCheckable = sql.value(++c).toBool();
         bool isCompleted = sql.value(++c).toBool();
 
-        ScheduleItem* item = new ScheduleItem(id, content, dueDate, isCheckable, isCompleted);
-        items << item;
+        if (!_tasks.contains(id))
+            _insertTask(new ScheduleItem(id, content, dueDate, isCheckable, isCompleted));
+    }
+}
 
-        if (minDate.isNull() || dueDate < minDate)
-            minDate = dueDate;
-        if (maxDate.isNull() || dueDate > maxDate)
-            maxDate = dueDate;
+QString ScheduleModel::_archiveCondition() const
+{
+    return _isArchiveShown ? QString() : QStringLiteral(" AND NOT (is_completed = 1 AND due_date < :today)");
+}
+
+bool ScheduleModel::_isShown(const QDate& dueDate, bool isCompleted) const
+{
+    return _isArchiveShown || !isCompleted || dueDate >= DateClock::instance()->today();
+}
+
+// existing month node or nullptr
+ScheduleItem* ScheduleModel::_month(const QDate& date) const
+{
+    QDate yearDate(date.year(), 1, 1);
+    ScheduleItem* year = _root->child(_root->childRow(yearDate));
+    if (!year || year->dueDate() != yearDate)
+        return nullptr;
+
+    QDate monthDate(date.year(), date.month(), 1);
+    ScheduleItem* month = year->child(year->childRow(monthDate));
+    return month && month->dueDate() == monthDate ? month : nullptr;
+}
+
+// returns the day node, creating the year/month/day nodes on the way
+ScheduleItem* ScheduleModel::_findDay(const QDate& date)
+{
+    ScheduleItem* day = _days.value(date);
+    if (day)
+        return day;
+
+    ScheduleItem* year = _findChild(_root, ScheduleItem::Year, QDate(date.year(), 1, 1));
+    ScheduleItem* month = _findChild(year, ScheduleItem::Month, QDate(date.year(), date.month(), 1));
+    day = _findChild(month, ScheduleItem::Day, date);
+    _days[date] = day;
+    return day;
+}
+
+ScheduleItem* ScheduleModel::_findChild(ScheduleItem* parent, int type, const QDate& date)
+{
+    int row = parent->childRow(date);
+    ScheduleItem* child = parent->child(row);
+    if (child && child->dueDate() == date)
+        return child;
+
+    child = new ScheduleItem(type, date);
+    if (_isLoading) {
+        parent->insertChild(row, child);
+    } else {
+        beginInsertRows(indexFromItem(parent), row, row);
+        parent->insertChild(row, child);
+        endInsertRows();
     }
+    return child;
+}
+
+void ScheduleModel::_insertTask(ScheduleItem* task)
+{
+    ScheduleItem* day = _findDay(task->dueDate());
+    int row = day->childRow(task->dueDate(), task->id());
+
+    if (_isLoading) {
+        day->insertChild(row, task);
+    } else {
+        beginInsertRows(indexFromItem(day), row, row);
+        day->insertChild(row, task);
+        endInsertRows();
+    }
+
+    _tasks[task->id()] = task;
+}
+
+void ScheduleModel::_moveTask(ScheduleItem* task, const QDate& dueDate)
+{
+    // the new day is created first, it may shift the rows above the task
+    ScheduleItem* newDay = _findDay(dueDate);
+    ScheduleItem* oldDay = task->parent();
+    int oldRow = task->row();
+    int newRow = newDay->childRow(dueDate, task->id());
+
+    beginMoveRows(indexFromItem(oldDay), oldRow, oldRow, indexFromItem(newDay), newRow);
+    oldDay->takeChild(oldRow);
+    task->setDueDate(dueDate);
+    newDay->insertChild(newRow, task);
+    endMoveRows();
+
+    _pruneDay(oldDay);
+}
+
+void ScheduleModel::_removeTask(ScheduleItem* task)
+{
+    ScheduleItem* day = task->parent();
+    int row = task->row();
+
+    beginRemoveRows(indexFromItem(day), row, row);
+    day->takeChild(row);
+    endRemoveRows();
+
+    _tasks.remove(task->id());
+    delete task;
+
+    _pruneDay(day);
+}
+
+// removes a day without tasks together with its month and year if they became empty
+void ScheduleModel::_pruneDay(ScheduleItem* day)
+{
+    QDate date = day->dueDate();
+    QDate today = DateClock::instance()->today();
+    if (day->childCount() > 0 || (date >= today && date < today.addDays(_emptyDays)))
+        return;
 
-    if (items.length() == 0)
+    _days.remove(date);
+    ScheduleItem* month = day->parent();
+    _removeNode(day);
+    if (month->childCount() > 0)
         return;
 
-    QHash<int, ScheduleItem*> years;
-    QHash<int, ScheduleItem*> months;
-    QHash<QDate, ScheduleItem*> days;
-    QDate currDate = minDate;
-    while (currDate <= maxDate) {
-        int y = currDate.year();
-        if (!years.contains(y)) {
-            years[y] = new ScheduleItem(y, ScheduleItem::Year);
-            _root->appendChild(years[y]);
-        }
+    ScheduleItem* year = month->parent();
+    _removeNode(month);
+    if (year->childCount() == 0)
+        _removeNode(year);
+}
 
-        int m = currDate.month();
-        int mm = y * 100 + m;
-        if (!months.contains(mm)) {
-            months[mm] = new ScheduleItem(m, ScheduleItem::Month, currDate.toString("MMMM"));
-            years[y]->appendChild(months[mm]);
-        }
+void ScheduleModel::_removeNode(ScheduleItem* item)
+{
+    ScheduleItem* parent = item->parent();
+    int row = item->row();
+
+    beginRemoveRows(indexFromItem(parent), row, row);
+    parent->takeChild(row);
+    endRemoveRows();
+
+    delete item;
+}
 
-        if (!days.contains(currDate)) {
-            days[currDate] = new ScheduleItem(currDate);
-            months[mm]->appendChild(days[currDate]);
+void ScheduleModel::_changeDate(const QDate& today, const QDate& previous)
+{
+    // completed tasks of the past days go to the archive
+    if (!_isArchiveShown) {
+        QList<ScheduleItem*> archived;
+        for (auto it = _days.lowerBound(previous); it != _days.end() && it.key() < today; ++it)
+            for (int row = 0, n = it.value()->childCount(); row < n; ++row)
+                if (it.value()->child(row)->isCompleted())
+                    archived << it.value()->child(row);
+        for (auto task : archived)
+            _removeTask(task);
+    }
+
+    // the empty days window moves with today
+    QList<ScheduleItem*> pastDays;
+    for (auto it = _days.lowerBound(previous); it != _days.end() && it.key() < today; ++it)
+        pastDays << it.value();
+    for (auto day : pastDays)
+        _pruneDay(day);
+    for (int i = 0; i < _emptyDays; ++i)
+        _findDay(today.addDays(i));
+
+    for (const QDate& date : { previous, today }) {
+        ScheduleItem* day = _days.value(date);
+        if (day) {
+            QModelIndex index = indexFromItem(day);
+            emit dataChanged(index, index, QVector<int>{Qt::BackgroundRole});
         }
+    }
+}
+
+void ScheduleModel::updateTask(ListItem* item)
+{
+    ScheduleItem* task = _tasks.value(item->id());
+    bool isShown = item->dueDate().isValid() && !item->isCancelled() && _isShown(item->dueDate(), item->isCompleted());
+
+    // tasks of a month which is not fetched yet are loaded with it
+    ScheduleItem* month = isShown ? _month(item->dueDate()) : nullptr;
+    if (month && !month->isFetched())
+        isShown = false;
 
-        currDate = currDate.addDays(1);
+    if (!isShown) {
+        if (task)
+            _removeTask(task);
+        return;
     }
 
-    for (auto item : items) {
-        days[item->dueDate()]->appendChild(item);
+    if (!task) {
+        _insertTask(new ScheduleItem(item->id(), item->markdown(), item->dueDate(), item->isCheckable(), item->isCompleted()));
+        return;
     }
+
+    if (task->dueDate() != item->dueDate())
+        _moveTask(task, item->dueDate());
+
+    task->setContent(item->markdown());
+    task->setCheckable(item->isCheckable());
+    task->setCompleted(item->isCompleted());
+    QModelIndex index = indexFromItem(task);
+    emit dataChanged(index, index);
+}
+
+void ScheduleModel::removeTask(int itemId)
+{
+    ScheduleItem* task = _tasks.value(itemId);
+    if (task)
+        _removeTask(task);
 }
 
 int ScheduleModel::rowCount(const QModelIndex& parent) const
@@ -83,6 +290,24 @@ int ScheduleModel::rowCount(const QModelIndex& parent) const
     return parent.column() > 0 ? 0 : itemFromIndex(parent)->childCount();
 }
 
+bool ScheduleModel::hasChildren(const QModelIndex& parent) const
+{
+    ScheduleItem* item = itemFromIndex(parent);
+    return !item->isFetched() || QAbstractItemModel::hasChildren(parent);
+}
+
+bool ScheduleModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !itemFromIndex(parent)->isFetched();
+}
+
+void ScheduleModel::fetchMore(const QModelIndex& parent)
+{
+    ScheduleItem* item = itemFromIndex(parent);
+    if (!item->isFetched())
+        _fetchMonth(item);
+}
+
 QModelIndex ScheduleModel::index(int row, int column, const QModelIndex& parent) const
 {
     if (row < 0 || column < 0)
@@ -197,11 +422,35 @@ void ScheduleModel::clear()
 {
     beginResetModel();
     _root->clear();
+    _tasks.clear();
+    _days.clear();
     endResetModel();
 }
 
+void ScheduleModel::setEmptyDays(int days)
+{
+    if (days == _emptyDays)
+        return;
+    _emptyDays = days;
+    reload();
+}
+
+void ScheduleModel::setArchiveShown(bool isShown)
+{
+    if (isShown == _isArchiveShown)
+        return;
+    _isArchiveShown = isShown;
+    reload();
+}
+
 void ScheduleModel::reload()
 {
-    clear();
+    beginResetModel();
+    _root->clear();
+    _tasks.clear();
+    _days.clear();
+    _isLoading = true;
     _loadItems();
+    _isLoading = false;
+    endResetModel();
 }
@@ -3,8 +3,11 @@
 #include "scheduleitem.h"
 
 #include <QAbstractItemModel>
+#include <QHash>
+#include <QMap>
 
 class ScheduleTree;
+class ListItem;
 
 class ScheduleModel : public QAbstractItemModel
 {
@@ -16,6 +19,9 @@ public:
     ScheduleItem* root() const { return _root; };
 
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
     int columnCount(const QModelIndex& parent = QModelIndex()) const override
     {
         Q_UNUSED(parent);
@@ -36,12 +42,40 @@ public:
     QModelIndex indexFromItem(ScheduleItem* item) const { return item->isRoot() ? QModelIndex() : createIndex(item->row(), 0, item); };
 
     void clear();
+
+    // days in [today, today + days) are shown even when they have no tasks
+    int emptyDays() const { return _emptyDays; };
+    void setEmptyDays(int days);
+
+    // completed tasks due before today
+    bool isArchiveShown() const { return _isArchiveShown; };
+    void setArchiveShown(bool isShown);
 public slots:
     void reload();
+    void updateTask(ListItem* item);
+    void removeTask(int itemId);
 private:
     ScheduleItem* _root{nullptr};
+    QHash<int, ScheduleItem*> _tasks; // by list item id
+    QMap<QDate, ScheduleItem*> _days;
+    bool _isLoading{false}; // rows are inserted inside a model reset
+    int _emptyDays{7};
+    int _eagerMonths{3}; // fetched on load starting with the current month
+    bool _isArchiveShown{false};
 
     void _loadItems();
+    void _fetchMonth(ScheduleItem* month);
+    QString _archiveCondition() const;
+    bool _isShown(const QDate& dueDate, bool isCompleted) const;
+    ScheduleItem* _month(const QDate& date) const;
+    ScheduleItem* _findDay(const QDate& date);
+    ScheduleItem* _findChild(ScheduleItem* parent, int type, const QDate& date);
+    void _insertTask(ScheduleItem* task);
+    void _moveTask(ScheduleItem* task, const QDate& dueDate);
+    void _removeTask(ScheduleItem* task);
+    void _pruneDay(ScheduleItem* day);
+    void _removeNode(ScheduleItem* item);
+    void _changeDate(const QDate& today, const QDate& previous);
     QVariant _dataContent(ScheduleItem* item, int role) const;
     bool _setDataContent(ScheduleItem* item, const QVariant& value, int role);
 };
@@ -11,5 +11,29 @@ ScheduleTree::ScheduleTree(QWidget* parent) : QTreeView(parent)
     _model = new ScheduleModel(this);
     setModel(_model);
 
-    expandAll();
+    // expanding a month which is not fetched yet would load it
+    _expandFetched(QModelIndex());
+    connect(_model, &ScheduleModel::modelReset, [this]() { _expandFetched(QModelIndex()); });
+
+    // new year/month/day nodes are expanded like the ones loaded at startup
+    connect(_model, &ScheduleModel::rowsInserted, [this](const QModelIndex& parent, int first, int last) {
+        for (int row = first; row <= last; ++row) {
+            QModelIndex index = _model->index(row, 0, parent);
+            ScheduleItem* item = _model->itemFromIndex(index);
+            if (item->type() != ScheduleItem::Task && item->isFetched())
+                expand(index);
+        }
+    });
+}
+
+void ScheduleTree::_expandFetched(const QModelIndex& parent)
+{
+    for (int row = 0, n = _model->rowCount(parent); row < n; ++row) {
+        QModelIndex index = _model->index(row, 0, parent);
+        ScheduleItem* item = _model->itemFromIndex(index);
+        if (item->type() == ScheduleItem::Task || !item->isFetched())
+            continue;
+        expand(index);
+        _expandFetched(index);
+    }
 }
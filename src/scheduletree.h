@@ -12,12 +12,10 @@ public:
     class ScheduleTree(QWidget* parent);
     ScheduleModel* model() const { return _model; };
 public slots:
-    void reload()
-    {
-        _model->reload();
-        expandAll();
-    }
+    void reload() { _model->reload(); };
 private:
     ScheduleModel* _model{nullptr};
     ScheduleItemDelegate* _delegate{nullptr};
+
+    void _expandFetched(const QModelIndex& parent);
 };
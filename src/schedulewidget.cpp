@@ -8,3 +8,9 @@ ScheduleWidget::ScheduleWidget(QWidget* parent) : QWidget(parent)
     _layout->setContentsMargins(0, 0, 0, 0);
     _layout->addWidget(_tree);
 }
+
+void ScheduleWidget::toggleArchive()
+{
+    ScheduleModel* model = _tree->model();
+    model->setArchiveShown(!model->isArchiveShown());
+}
@@ -12,6 +12,9 @@ public:
     ScheduleWidget(QWidget* parent = 0);
 public slots:
     void reload() { _tree->reload(); };
+    void updateTask(ListItem* item) { _tree->model()->updateTask(item); };
+    void removeTask(int itemId) { _tree->model()->removeTask(itemId); };
+    void toggleArchive();
 private:
     QVBoxLayout* _layout{nullptr};
     ScheduleTree* _tree{nullptr};
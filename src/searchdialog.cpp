@@ -0,0 +1,126 @@
+#include "searchdialog.h"
+#include "htmldelegate.h"
+#include "sqlquery.h"
+
+#include <QApplication>
+#include <QKeyEvent>
+#include <QDebug>
+
+SearchDialog::SearchDialog(QWidget* parent) : QDialog(parent)
+{
+    setWindowIcon(QIcon(":app.png"));
+    setWindowTitle("Search");
+
+    _queryEdit = new QLineEdit(this);
+    _queryEdit->setPlaceholderText("Search items");
+    _queryEdit->installEventFilter(this);
+
+    _results = new QListWidget(this);
+    _results->setItemDelegate(new HtmlDelegate(_results));
+    _results->setAlternatingRowColors(true);
+
+    _layout = new QVBoxLayout(this);
+    _layout->addWidget(_queryEdit);
+    _layout->addWidget(_results);
+
+    // search once typing pauses
+    _searchTimer.setSingleShot(true);
+    _searchTimer.setInterval(150);
+    connect(&_searchTimer, &QTimer::timeout, this, &SearchDialog::_search);
+    connect(_queryEdit, &QLineEdit::textChanged, [this]() { _searchTimer.start(); });
+    connect(_queryEdit, &QLineEdit::returnPressed, [this]() {
+        _searchTimer.stop();
+        _search();
+        _select(_results->currentItem());
+    });
+    connect(_results, &QListWidget::itemActivated, this, &SearchDialog::_select);
+}
+
+QSize SearchDialog::sizeHint() const
+{
+    return QSize(600, 400);
+}
+
+// up and down in the query box move through the results
+bool SearchDialog::eventFilter(QObject* object, QEvent* event)
+{
+    if (object == _queryEdit && event->type() == QEvent::KeyPress) {
+        int key = static_cast<QKeyEvent*>(event)->key();
+        if (key == Qt::Key_Up || key == Qt::Key_Down || key == Qt::Key_PageUp || key == Qt::Key_PageDown) {
+            QApplication::sendEvent(_results, event);
+            return true;
+        }
+    }
+    return QDialog::eventFilter(object, event);
+}
+
+bool SearchDialog::_isFts5()
+{
+    static int isFts5 = -1;
+    if (isFts5 == -1) {
+        SqlQuery sql;
+        sql.prepare("SELECT sql FROM sqlite_master WHERE name = 'list_item_fts'");
+        isFts5 = sql.exec() && sql.next() && sql.value(0).toString().contains("fts5", Qt::CaseInsensitive) ? 1 : 0;
+    }
+    return isFts5 == 1;
+}
+
+// every word is quoted so the input cannot use the query syntax, the last word is a prefix
+QString SearchDialog::_matchQuery(const QString& text, bool isFts5)
+{
+    QStringList words = text.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+    QStringList terms;
+    for (int i = 0; i < words.length(); ++i) {
+        QString word = words.at(i);
+        word.remove('"');
+        if (word.isEmpty())
+            continue;
+        if (i < words.length() - 1)
+            terms << '"' + word + '"';
+        else if (isFts5)
+            terms << '"' + word + "\"*";
+        else
+            terms << '"' + word + "*\"";
+    }
+    return terms.join(' ');
+}
+
+void SearchDialog::_search()
+{
+    _results->clear();
+
+    bool isFts5 = _isFts5();
+    QString query = _matchQuery(_queryEdit->text(), isFts5);
+    if (query.isEmpty())
+        return;
+
+    // the matches are marked with control characters so the markdown can be escaped before they become <b>
+    SqlQuery sql;
+    if (isFts5)
+        sql.prepare("SELECT list_item.id, list_item.list_id, snippet(list_item_fts, 0, char(1), char(2), '...', 16) "
+                    "FROM list_item_fts JOIN list_item ON list_item.id = list_item_fts.rowid "
+                    "WHERE list_item_fts MATCH :query ORDER BY rank LIMIT :limit");
+    else
+        sql.prepare("SELECT list_item.id, list_item.list_id, snippet(list_item_fts, char(1), char(2), '...', 0, 16) "
+                    "FROM list_item_fts JOIN list_item ON list_item.id = list_item_fts.docid "
+                    "WHERE list_item_fts MATCH :query LIMIT :limit");
+    sql.bindValue(":query", query);
+    sql.bindValue(":limit", _limit);
+    if (!sql.exec())
+        return;
+
+    while (sql.next()) {
+        QString snippet = sql.value(2).toString().toHtmlEscaped().replace(QChar(1), "<b>").replace(QChar(2), "</b>");
+        QListWidgetItem* item = new QListWidgetItem(snippet, _results);
+        item->setData(Qt::UserRole, sql.value(0).toInt());
+        item->setData(Qt::UserRole + 1, sql.value(1).toInt());
+    }
+    _results->setCurrentRow(0);
+}
+
+void SearchDialog::_select(QListWidgetItem* item)
+{
+    if (!item)
+        return;
+    emit itemSelected(item->data(Qt::UserRole + 1).toInt(), item->data(Qt::UserRole).toInt());
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QDialog>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QVBoxLayout>
+#include <QTimer>
+
+// Full text search over the content of all items, see DatabaseUtil::createSearchIndex
+class SearchDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    SearchDialog(QWidget* parent = 0);
+    QSize sizeHint() const;
+    bool eventFilter(QObject* object, QEvent* event);
+signals:
+    void itemSelected(int listId, int itemId);
+private:
+    QVBoxLayout* _layout{nullptr};
+    QLineEdit* _queryEdit{nullptr};
+    QListWidget* _results{nullptr};
+    QTimer _searchTimer;
+    int _limit{100};
+
+    void _search();
+    void _select(QListWidgetItem* item);
+
+    static bool _isFts5();
+    static QString _matchQuery(const QString& text, bool isFts5);
+};
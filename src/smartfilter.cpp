@@ -0,0 +1,288 @@
+#include "smartfilter.h"
+#include "dateclock.h"
+#include "tagindex.h"
+
+#include <QHash>
+#include <QRegularExpression>
+
+namespace {
+
+const QHash<QString, QString> dateColumns{
+    {"due", "due_date"},
+    {"completed_at", "completed_at"},
+    {"created", "created_at"},
+    {"modified", "modified_at"},
+};
+
+const QHash<QString, QString> flagColumns{
+    {"completed", "is_completed"},
+    {"cancelled", "is_cancelled"},
+    {"highlighted", "is_highlighted"},
+    {"project", "is_project"},
+    {"milestone", "is_milestone"},
+    {"task", "is_checkable"},
+};
+
+}
+
+SmartFilter::SmartFilter(const QString& query) : _query(query)
+{
+    _tokenize();
+    if (!isValid())
+        return;
+    if (_tokens.isEmpty()) {
+        _fail("Empty filter");
+        return;
+    }
+
+    _where = _parseOr();
+    if (isValid() && _pos < _tokens.length())
+        _fail(QString("Unexpected \"%1\"").arg(_tokens.at(_pos)));
+    if (!isValid()) {
+        _where.clear();
+        _values.clear();
+    }
+}
+
+bool SmartFilter::_fail(const QString& error)
+{
+    if (_error.isEmpty())
+        _error = error;
+    return false;
+}
+
+// parentheses, and terms like word, field:value or field:"quoted value"
+void SmartFilter::_tokenize()
+{
+    for (int i = 0, n = _query.length(); i < n;) {
+        QChar c = _query.at(i);
+        if (c.isSpace()) {
+            ++i;
+        } else if (c == '(' || c == ')') {
+            _tokens << QString(c);
+            ++i;
+        } else {
+            int start = i;
+            bool isQuoted = false;
+            while (i < n && (isQuoted || !(_query.at(i).isSpace() || _query.at(i) == '(' || _query.at(i) == ')'))) {
+                if (_query.at(i) == '"')
+                    isQuoted = !isQuoted;
+                ++i;
+            }
+            if (isQuoted) {
+                _fail("Unterminated quote");
+                return;
+            }
+            _tokens << _query.mid(start, i - start);
+        }
+    }
+}
+
+QString SmartFilter::_parseOr()
+{
+    QStringList terms{_parseAnd()};
+    while (isValid() && _pos < _tokens.length() && _tokens.at(_pos).toLower() == "or") {
+        ++_pos;
+        terms << _parseAnd();
+    }
+    return terms.length() == 1 ? terms.first() : '(' + terms.join(" OR ") + ')';
+}
+
+QString SmartFilter::_parseAnd()
+{
+    QStringList terms{_parseUnary()};
+    while (isValid() && _pos < _tokens.length() && _tokens.at(_pos) != ")" && _tokens.at(_pos).toLower() != "or") {
+        if (_tokens.at(_pos).toLower() == "and")
+            ++_pos;
+        terms << _parseUnary();
+    }
+    return terms.length() == 1 ? terms.first() : '(' + terms.join(" AND ") + ')';
+}
+
+QString SmartFilter::_parseUnary()
+{
+    if (_pos >= _tokens.length()) {
+        _fail("Unexpected end of filter");
+        return QString();
+    }
+
+    QString token = _tokens.at(_pos++);
+    if (token.toLower() == "not")
+        return "NOT " + _parseUnary();
+    if (token.startsWith('-') && token.length() > 1)
+        return "NOT " + _parseTerm(token.mid(1));
+    if (token == "(") {
+        QString expression = _parseOr();
+        if (_pos >= _tokens.length() || _tokens.at(_pos) != ")") {
+            _fail("Missing \")\"");
+            return QString();
+        }
+        ++_pos;
+        return expression;
+    }
+    if (token == ")" || token.toLower() == "and" || token.toLower() == "or") {
+        _fail(QString("Unexpected \"%1\"").arg(token));
+        return QString();
+    }
+    return _parseTerm(token);
+}
+
+QString SmartFilter::_parseTerm(const QString& token)
+{
+    static const QRegularExpression re("^([a-z_]+)(:|=|!=|<=|>=|<|>)(.*)$");
+    QRegularExpressionMatch match = re.match(token);
+
+    // bare word
+    if (!match.hasMatch()) {
+        QString word = token;
+        word.remove('"');
+        if (flagColumns.contains(word.toLower()))
+            return flagColumns.value(word.toLower()) + " = 1";
+        if (TagIndex::isTag(word))
+            return "id IN (SELECT item_id FROM item_tag WHERE tag = " + _bind(word.toLower()) + ')';
+        return "content LIKE " + _bind('%' + word + '%');
+    }
+
+    QString field = match.captured(1);
+    QString op = match.captured(2) == ":" ? "=" : match.captured(2);
+    QString value = match.captured(3);
+    if (value.startsWith('"') && value.endsWith('"') && value.length() >= 2)
+        value = value.mid(1, value.length() - 2);
+    if (value.isEmpty()) {
+        _fail(QString("Missing value for \"%1\"").arg(field));
+        return QString();
+    }
+
+    if (dateColumns.contains(field))
+        return _compareDate(dateColumns.value(field), op, value);
+
+    QString flag = value.toLower();
+    bool isOn = flag == "yes" || flag == "true" || flag == "1";
+    bool isFlag = isOn || flag == "no" || flag == "false" || flag == "0";
+
+    // project:"name" is handled below
+    if (flagColumns.contains(field) && (isFlag || field != "project")) {
+        if (!isFlag) {
+            _fail(QString("Invalid value \"%1\" for \"%2\"").arg(value, field));
+            return QString();
+        }
+        if (op != "=" && op != "!=") {
+            _fail(QString("Invalid operator for \"%1\"").arg(field));
+            return QString();
+        }
+        return flagColumns.value(field) + (isOn == (op == "=") ? " = 1" : " = 0");
+    }
+
+    if (field == "priority") {
+        bool isNumber = false;
+        int priority = value.toInt(&isNumber);
+        if (!isNumber) {
+            _fail(QString("Invalid priority \"%1\"").arg(value));
+            return QString();
+        }
+        return "priority " + op + ' ' + _bind(priority);
+    }
+
+    if (op != "=" && op != "!=") {
+        _fail(QString("Invalid operator for \"%1\"").arg(field));
+        return QString();
+    }
+    QString negation = op == "!=" ? "NOT " : "";
+
+    if (field == "text")
+        return negation + "content LIKE " + _bind('%' + value + '%');
+    if (field == "list")
+        return negation + "list_id IN (SELECT id FROM list WHERE name LIKE " + _bind(value) + ')';
+    // the project and all its descendants
+    if (field == "project")
+        return negation + "id IN (WITH RECURSIVE subtree(id) AS ("
+                          "SELECT id FROM list_item WHERE is_project = 1 AND content LIKE " + _bind(value) +
+               " UNION ALL SELECT list_item.id FROM list_item JOIN subtree ON list_item.parent_id = subtree.id) "
+               "SELECT id FROM subtree)";
+
+    _fail(QString("Unknown field \"%1\"").arg(field));
+    return QString();
+}
+
+// dates are compared as half open ranges on the stored text so both dates and timestamps can use their indexes. The
+// timestamps are stored in UTC by CURRENT_TIMESTAMP so the bounds of the local days are converted, the due dates are
+// local dates and skip the cancelled items like the schedule does, which lets the partial due_date index apply.
+QString SmartFilter::_compareDate(const QString& column, const QString& op, const QString& value)
+{
+    if (value.toLower() == "none") {
+        if (op == "=")
+            return column + " IS NULL";
+        if (op == "!=")
+            return column + " IS NOT NULL";
+        _fail(QString("Invalid operator for \"%1\"").arg(value));
+        return QString();
+    }
+
+    QDate start;
+    QDate end;
+    if (!_dateRange(value, &start, &end)) {
+        _fail(QString("Invalid date \"%1\"").arg(value));
+        return QString();
+    }
+    bool isTimestamp = column != "due_date";
+    QString from = _bind(start.toString(Qt::ISODate));
+    QString to = _bind(end.addDays(1).toString(Qt::ISODate));
+    if (isTimestamp) {
+        from = "datetime(" + from + ", 'utc')";
+        to = "datetime(" + to + ", 'utc')";
+    }
+
+    QString term;
+    if (op == "=")
+        term = '(' + column + " >= " + from + " AND " + column + " < " + to + ')';
+    else if (op == "!=")
+        term = '(' + column + " < " + from + " OR " + column + " >= " + to + ')';
+    else if (op == "<")
+        term = column + " < " + from;
+    else if (op == "<=")
+        term = column + " < " + to;
+    else if (op == ">")
+        term = column + " >= " + to;
+    else
+        term = column + " >= " + from;
+    if (isTimestamp)
+        return term;
+    return "(is_cancelled = 0 AND " + term + ')';
+}
+
+bool SmartFilter::_dateRange(const QString& value, QDate* start, QDate* end)
+{
+    QDate today = DateClock::instance()->today();
+    QString text = value.toLower();
+
+    static const QRegularExpression relative("^([+-]\\d+)d$");
+    QRegularExpressionMatch match = relative.match(text);
+
+    if (text == "today")
+        *start = today;
+    else if (text == "tomorrow")
+        *start = today.addDays(1);
+    else if (text == "yesterday")
+        *start = today.addDays(-1);
+    else if (text == "week") {
+        *start = today.addDays(1 - today.dayOfWeek());
+        *end = start->addDays(6);
+        return true;
+    } else if (text == "month") {
+        *start = QDate(today.year(), today.month(), 1);
+        *end = start->addMonths(1).addDays(-1);
+        return true;
+    } else if (match.hasMatch())
+        *start = today.addDays(match.captured(1).toInt());
+    else
+        *start = QDate::fromString(value, Qt::ISODate);
+
+    *end = *start;
+    return start->isValid();
+}
+
+QString SmartFilter::_bind(const QVariant& value)
+{
+    _values << value;
+    return ":p" + QString::number(_values.length() - 1);
+}
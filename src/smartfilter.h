@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QDate>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+
+// Filter over the list_item columns compiled to a parameterized WHERE clause. Terms are joined by "and" (implicit)
+// and "or", "not" or "-" negates a term and parentheses group them:
+//   priority:1 due:week
+//   highlighted project:"Website"
+//   completed completed_at>=-30d
+// Dates are YYYY-MM-DD, today, tomorrow, yesterday, week, month, +Nd, -Nd or none; a bare #tag or @context matches
+// the tagged items and any other word matches the content.
+class SmartFilter
+{
+public:
+    SmartFilter(const QString& query);
+
+    QString query() const { return _query; };
+    bool isValid() const { return _error.isEmpty(); };
+    QString error() const { return _error; };
+
+    QString where() const { return _where; };
+    QVariantList values() const { return _values; }; // bound to :p0, :p1...
+private:
+    QString _query;
+    QString _error;
+    QString _where;
+    QVariantList _values;
+
+    QStringList _tokens;
+    int _pos{0};
+
+    void _tokenize();
+    QString _parseOr();
+    QString _parseAnd();
+    QString _parseUnary();
+    QString _parseTerm(const QString& token);
+    QString _compareDate(const QString& column, const QString& op, const QString& value);
+    QString _bind(const QVariant& value);
+    bool _fail(const QString& error);
+
+    static bool _dateRange(const QString& value, QDate* start, QDate* end);
+};
@@ -0,0 +1,63 @@
+#include "smartfilterview.h"
+#include "smartfilter.h"
+#include "htmldelegate.h"
+#include "markdownrenderer.h"
+#include "sqlquery.h"
+
+SmartFilterView::SmartFilterView(int filterId, const QString& query, QWidget* parent)
+    : QListWidget(parent), _filterId(filterId), _query(query)
+{
+    setItemDelegate(new HtmlDelegate(this));
+    setAlternatingRowColors(true);
+
+    // a burst of changes reloads once
+    _reloadTimer.setSingleShot(true);
+    _reloadTimer.setInterval(200);
+    connect(&_reloadTimer, &QTimer::timeout, this, &SmartFilterView::reload);
+
+    connect(this, &QListWidget::itemActivated, [this](QListWidgetItem* item) {
+        emit itemSelected(item->data(Qt::UserRole + 1).toInt(), item->data(Qt::UserRole).toInt());
+    });
+}
+
+void SmartFilterView::showEvent(QShowEvent* event)
+{
+    if (_isStale)
+        reload();
+    QListWidget::showEvent(event);
+}
+
+void SmartFilterView::invalidate()
+{
+    _isStale = true;
+    if (isVisible())
+        _reloadTimer.start();
+}
+
+void SmartFilterView::reload()
+{
+    _isStale = false;
+    clear();
+
+    SmartFilter filter(_query);
+    if (!filter.isValid()) {
+        addItem(filter.error());
+        return;
+    }
+
+    SqlQuery sql;
+    sql.prepare("SELECT id, list_id, content FROM list_item WHERE " + filter.where() +
+                " ORDER BY due_date IS NULL, due_date, priority DESC, id LIMIT :limit");
+    QVariantList values = filter.values();
+    for (int i = 0; i < values.length(); ++i)
+        sql.bindValue(":p" + QString::number(i), values.at(i));
+    sql.bindValue(":limit", _limit);
+    if (!sql.exec())
+        return;
+
+    while (sql.next()) {
+        QListWidgetItem* item = new QListWidgetItem(MarkdownRenderer::render(sql.value(2).toString()).html, this);
+        item->setData(Qt::UserRole, sql.value(0).toInt());
+        item->setData(Qt::UserRole + 1, sql.value(1).toInt());
+    }
+}
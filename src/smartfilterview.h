@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QListWidget>
+#include <QTimer>
+
+// Items of all lists matching a saved smart filter. The results are kept until a list changes, then they are
+// queried again as soon as the view is shown.
+class SmartFilterView : public QListWidget
+{
+    Q_OBJECT
+public:
+    SmartFilterView(int filterId, const QString& query, QWidget* parent = 0);
+
+    int filterId() const { return _filterId; };
+    QString query() const { return _query; };
+public slots:
+    void invalidate();
+    void reload();
+signals:
+    void itemSelected(int listId, int itemId);
+protected:
+    void showEvent(QShowEvent* event);
+private:
+    int _filterId{0};
+    QString _query;
+    bool _isStale{true};
+    QTimer _reloadTimer;
+    int _limit{500};
+};
@@ -0,0 +1,131 @@
+#include "tagindex.h"
+
+#include "sqlquery.h"
+
+#include <QCoreApplication>
+#include <QRegularExpression>
+#include <QSqlDatabase>
+#include <algorithm>
+
+namespace {
+
+// preceded by the start or a space so emails, urls and headings are not tags
+const QRegularExpression tagRe("(?:^|(?<=[\\s(\\[,;]))([#@]\\w(?:[\\w/-]*\\w)?)", QRegularExpression::UseUnicodePropertiesOption);
+
+}
+
+TagIndex* TagIndex::instance()
+{
+    static TagIndex* index = new TagIndex(QCoreApplication::instance());
+    return index;
+}
+
+TagIndex::TagIndex(QObject* parent) : QObject(parent) {}
+
+// lower case, without duplicates
+QStringList TagIndex::extract(const QString& markdown)
+{
+    QStringList tags;
+    QRegularExpressionMatchIterator it = tagRe.globalMatch(markdown);
+    while (it.hasNext()) {
+        QString tag = it.next().captured(1).toLower();
+        if (!tags.contains(tag))
+            tags << tag;
+    }
+    return tags;
+}
+
+bool TagIndex::isTag(const QString& text)
+{
+    QRegularExpressionMatch match = tagRe.match(text);
+    return match.hasMatch() && match.capturedStart(1) == 0 && match.capturedLength(1) == text.length();
+}
+
+void TagIndex::_load()
+{
+    _isLoaded = true;
+
+    SqlQuery sql;
+    sql.prepare("SELECT item_id, tag FROM item_tag");
+    if (!sql.exec())
+        return;
+    while (sql.next())
+        _add(sql.value(0).toInt(), sql.value(1).toString());
+}
+
+void TagIndex::_add(int itemId, const QString& tag)
+{
+    _items[tag].insert(itemId);
+    _tags[itemId].append(tag);
+}
+
+void TagIndex::_remove(int itemId)
+{
+    for (const QString& tag : _tags.take(itemId)) {
+        auto it = _items.find(tag);
+        if (it == _items.end())
+            continue;
+        it.value().remove(itemId);
+        if (it.value().isEmpty())
+            _items.erase(it);
+    }
+}
+
+void TagIndex::setTags(int itemId, const QStringList& tags)
+{
+    // part of the caller transaction if there is one
+    QSqlDatabase db = QSqlDatabase::database();
+    bool isTransaction = db.transaction();
+
+    SqlQuery sql;
+    sql.prepare("DELETE FROM item_tag WHERE item_id = :id");
+    sql.bindValue(":id", itemId);
+    bool ok = sql.exec();
+    for (int i = 0; ok && i < tags.length(); ++i) {
+        sql.prepare("INSERT INTO item_tag (item_id, tag) VALUES (:id, :tag)");
+        sql.bindValue(":id", itemId);
+        sql.bindValue(":tag", tags.at(i));
+        ok = sql.exec();
+    }
+    if (isTransaction)
+        ok ? db.commit() : db.rollback();
+    if (!ok)
+        return;
+
+    // changes before the first load are already in the database
+    if (!_isLoaded)
+        return;
+    _remove(itemId);
+    for (const QString& tag : tags)
+        _add(itemId, tag);
+    emit tagsChanged();
+}
+
+void TagIndex::removeItem(int itemId)
+{
+    if (!_isLoaded || !_tags.contains(itemId))
+        return;
+    _remove(itemId);
+    emit tagsChanged();
+}
+
+QSet<int> TagIndex::items(const QString& tag)
+{
+    if (!_isLoaded)
+        _load();
+    return _items.value(tag.toLower());
+}
+
+QList<QPair<QString, int>> TagIndex::counts()
+{
+    if (!_isLoaded)
+        _load();
+
+    QList<QPair<QString, int>> counts;
+    for (auto it = _items.begin(); it != _items.end(); ++it)
+        counts << qMakePair(it.key(), it.value().size());
+    std::sort(counts.begin(), counts.end(), [](const QPair<QString, int>& a, const QPair<QString, int>& b) {
+        return a.second > b.second || (a.second == b.second && a.first < b.first);
+    });
+    return counts;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
+// #tags and @contexts of the items. The item_tag table is the stored copy, the inverted index from tag to item ids
+// is loaded on first use and then kept current as items are edited and removed.
+class TagIndex : public QObject
+{
+    Q_OBJECT
+public:
+    static TagIndex* instance();
+
+    static QStringList extract(const QString& markdown);
+    static bool isTag(const QString& text);
+
+    void setTags(int itemId, const QStringList& tags);
+    void removeItem(int itemId); // the rows are removed by a trigger
+
+    QSet<int> items(const QString& tag);
+    QList<QPair<QString, int>> counts(); // most used first
+signals:
+    void tagsChanged();
+private:
+    TagIndex(QObject* parent = 0);
+
+    bool _isLoaded{false};
+    QHash<QString, QSet<int>> _items;
+    QHash<int, QStringList> _tags;
+
+    void _load();
+    void _add(int itemId, const QString& tag);
+    void _remove(int itemId);
+};
@@ -0,0 +1,79 @@
+#include "trigramindex.h"
+
+#include "listitem.h"
+
+QSet<quint64> TrigramIndex::_trigrams(const QString& text)
+{
+    QSet<quint64> trigrams;
+    const QChar* data = text.constData();
+    for (int i = 0, n = text.length() - 2; i < n; ++i)
+        trigrams.insert(quint64(data[i].unicode()) << 32 | quint64(data[i + 1].unicode()) << 16 | data[i + 2].unicode());
+    return trigrams;
+}
+
+void TrigramIndex::insert(ListItem* item)
+{
+    QString text = item->text().toLower();
+    _texts[item] = text;
+    for (quint64 trigram : _trigrams(text))
+        _postings[trigram].insert(item);
+}
+
+void TrigramIndex::remove(ListItem* item)
+{
+    auto it = _texts.find(item);
+    if (it == _texts.end())
+        return;
+
+    for (quint64 trigram : _trigrams(it.value())) {
+        auto posting = _postings.find(trigram);
+        if (posting == _postings.end())
+            continue;
+        posting.value().remove(item);
+        if (posting.value().isEmpty())
+            _postings.erase(posting);
+    }
+    _texts.erase(it);
+}
+
+void TrigramIndex::update(ListItem* item)
+{
+    remove(item);
+    insert(item);
+}
+
+void TrigramIndex::clear()
+{
+    _postings.clear();
+    _texts.clear();
+}
+
+QList<ListItem*> TrigramIndex::find(const QString& text) const
+{
+    QString query = text.toLower();
+    QList<ListItem*> items;
+    if (query.isEmpty())
+        return items;
+
+    // too short to have a trigram
+    if (query.length() < 3) {
+        for (auto it = _texts.begin(); it != _texts.end(); ++it)
+            if (it.value().contains(query))
+                items << it.key();
+        return items;
+    }
+
+    const QSet<ListItem*>* smallest = nullptr;
+    for (quint64 trigram : _trigrams(query)) {
+        auto posting = _postings.find(trigram);
+        if (posting == _postings.end())
+            return items;
+        if (!smallest || posting.value().size() < smallest->size())
+            smallest = &posting.value();
+    }
+
+    for (ListItem* item : *smallest)
+        if (_texts.value(item).contains(query))
+            items << item;
+    return items;
+}
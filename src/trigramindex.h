@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+class ListItem;
+
+// Case insensitive substring lookup over the plain text of the items of one list. Every item is stored under each
+// sequence of three characters of its text, a query reads the smallest posting set and checks the candidates.
+class TrigramIndex
+{
+public:
+    void insert(ListItem* item);
+    void remove(ListItem* item);
+    void update(ListItem* item);
+    void clear();
+
+    QList<ListItem*> find(const QString& text) const;
+private:
+    QHash<quint64, QSet<ListItem*>> _postings;
+    QHash<ListItem*, QString> _texts; // lower case
+
+    static QSet<quint64> _trigrams(const QString& text);
+};